@@ -0,0 +1,12 @@
+#version 330 core
+
+in vec2 uv;
+
+out vec4 FragColor;
+
+uniform sampler2D uLayer;
+uniform vec4 uDim;  // overlay colour, alpha is how much of it covers the layer
+
+void main() {
+    FragColor = vec4(mix(texture(uLayer, uv).rgb, uDim.rgb, uDim.a), 1.0);
+}
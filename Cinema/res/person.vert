@@ -0,0 +1,10 @@
+#version 330 core
+
+layout(location = 0) in vec2 inPos;
+layout(location = 1) in vec2 inPosition;  // per person
+
+uniform vec2 uScale;
+
+void main() {
+    gl_Position = vec4(inPos * uScale + inPosition, 0.0, 1.0);
+}
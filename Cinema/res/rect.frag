@@ -1,9 +1,12 @@
 #version 330 core
 
+in vec4 instanceColor;
+
 out vec4 FragColor;
 
 uniform vec4 uColor; 
+uniform bool uInstanced;
 
 void main() {
-    FragColor = uColor;
+    FragColor = uInstanced ? instanceColor : uColor;
 }
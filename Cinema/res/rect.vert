@@ -1,10 +1,28 @@
 #version 330 core
 
 layout(location = 0) in vec2 inPos;
+layout(location = 1) in float inInstanceX;
+layout(location = 2) in float inInstanceY;
 
 uniform vec2 uScale;   
 uniform vec2 uOffset;  
 
+uniform bool uInstanced;
+uniform vec4 uPalette[3];
+uniform usampler2D uSeatStates;  // one texel per seat, row-major
+
+out vec4 instanceColor;
+
 void main() {
-    gl_Position = vec4(inPos * uScale + uOffset, 0.0, 1.0);
+    vec2 offset = uOffset;
+    instanceColor = vec4(0.0);
+
+    if (uInstanced) {
+        offset += vec2(inInstanceX, inInstanceY);
+        int width = textureSize(uSeatStates, 0).x;
+        uint state = texelFetch(uSeatStates, ivec2(gl_InstanceID % width, gl_InstanceID / width), 0).r;
+        instanceColor = uPalette[state];
+    }
+
+    gl_Position = vec4(inPos * uScale + offset, 0.0, 1.0);
 }
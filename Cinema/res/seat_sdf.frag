@@ -0,0 +1,25 @@
+#version 330 core
+
+in vec2 localPos;
+in vec4 seatColor;
+
+out vec4 FragColor;
+
+// signed distance to a box with rounded corners, negative inside
+float roundBox(vec2 p, vec2 center, vec2 halfSize, float radius) {
+    vec2 q = abs(p - center) - halfSize + radius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+void main() {
+    float d = roundBox(localPos, vec2(0.0, 0.3), vec2(0.55, 0.2), 0.08);          // backrest
+    d = min(d, roundBox(localPos, vec2(0.0, -0.3), vec2(0.6, 0.2), 0.06));        // cushion
+    d = min(d, roundBox(localPos, vec2(-0.675, 0.0), vec2(0.075, 0.3), 0.05));    // left armrest
+    d = min(d, roundBox(localPos, vec2(0.675, 0.0), vec2(0.075, 0.3), 0.05));     // right armrest
+
+    // one pixel wide edge, whatever the seat size on screen
+    float coverage = clamp(0.5 - d / fwidth(d), 0.0, 1.0);
+    if (coverage == 0.0) discard;
+
+    FragColor = vec4(seatColor.rgb, seatColor.a * coverage);
+}
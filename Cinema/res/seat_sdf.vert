@@ -0,0 +1,23 @@
+#version 330 core
+
+layout(location = 0) in vec2 inPos;
+layout(location = 1) in float inInstanceX;
+layout(location = 2) in float inInstanceY;
+
+uniform vec2 uScale;
+uniform vec2 uOffset;
+
+uniform vec4 uPalette[3];
+uniform usampler2D uSeatStates;  // one texel per seat, row-major
+
+out vec2 localPos;  // seat units, the space the fragment shader's shapes are defined in
+out vec4 seatColor;
+
+void main() {
+    int width = textureSize(uSeatStates, 0).x;
+    uint state = texelFetch(uSeatStates, ivec2(gl_InstanceID % width, gl_InstanceID / width), 0).r;
+    seatColor = uPalette[state];
+
+    localPos = inPos;
+    gl_Position = vec4(inPos * uScale + uOffset + vec2(inInstanceX, inInstanceY), 0.0, 1.0);
+}
@@ -0,0 +1,250 @@
+#include "BookingEngine.h"
+
+#include <thread>
+#include <vector>
+
+constexpr int MAX_TXN_ATTEMPTS = 64;
+
+void BookingEngine::reset(const Hall &hall) {
+    if (count != hall.size() || cols != hall.cols) {
+        count = hall.size();
+        cols = hall.cols;
+        states.reset(new std::atomic<uint32_t>[count]);
+        rowVersions.reset(new std::atomic<uint32_t>[hall.rows]);
+
+        dirtyWords = (count + 63) / 64;
+        dirty.reset(new std::atomic<uint64_t>[dirtyWords]);
+    }
+
+    for (int r = 0; r < hall.rows; r++)
+        rowVersions[r].store(0, std::memory_order_relaxed);
+
+    for (int i = 0; i < count; i++)
+        states[i].store(hall.states[i], std::memory_order_relaxed);
+
+    for (int w = 0; w < dirtyWords; w++)
+        dirty[w].store(0, std::memory_order_relaxed);
+
+    anyDirty.store(false, std::memory_order_release);
+
+    if (journal) journal->appendReset();
+}
+
+bool BookingEngine::swapState(int seat, unsigned char from, unsigned char to, uint32_t &generation) {
+    uint32_t word = states[seat].load(std::memory_order_acquire);
+
+    do {
+        if ((word & 0xff) != from) return false;
+        generation = (word >> 8) + 1;
+    } while (!states[seat].compare_exchange_weak(word, generation << 8 | to, std::memory_order_acq_rel));
+
+    return true;
+}
+
+// Makes a completed transition visible: row version, dirty bit and journal
+void BookingEngine::publish(int seat, unsigned char from, unsigned char to, uint32_t generation) {
+    rowVersions[seat / cols].fetch_add(2, std::memory_order_acq_rel);
+    markDirty(seat);
+
+    if (journal) journal->append(seat, from, to, generation);
+}
+
+bool BookingEngine::transition(int seat, unsigned char from, unsigned char to) {
+    uint32_t generation;
+    if (!swapState(seat, from, to, generation))
+        return false;
+
+    publish(seat, from, to, generation);
+    return true;
+}
+
+void BookingEngine::markDirty(int seat) {
+    dirty[seat / 64].fetch_or(1ull << (seat % 64), std::memory_order_release);
+    anyDirty.store(true, std::memory_order_release);
+}
+
+bool BookingEngine::reserve(int seat) {
+    return transition(seat, Seat::FREE, Seat::RESERVED);
+}
+
+bool BookingEngine::cancel(int seat) {
+    return transition(seat, Seat::RESERVED, Seat::FREE);
+}
+
+bool BookingEngine::toggle(int seat) {
+    // Retry only if the seat flipped between FREE and RESERVED under us
+    for (;;) {
+        unsigned char s = state(seat);
+
+        if (s == Seat::FREE && reserve(seat)) return true;
+        if (s == Seat::RESERVED && cancel(seat)) return true;
+        if (s == Seat::PURCHASED) return false;
+    }
+}
+
+bool BookingEngine::expireHold(int seat, uint32_t generation) {
+    uint32_t word = generation << 8 | Seat::RESERVED;
+    if (!states[seat].compare_exchange_strong(word, (generation + 1) << 8 | Seat::FREE, std::memory_order_acq_rel))
+        return false;
+
+    publish(seat, Seat::RESERVED, Seat::FREE, generation + 1);
+    return true;
+}
+
+bool BookingEngine::purchase(const int *seats, int count) {
+    std::vector<uint32_t> generations(count);
+
+    for (int i = 0; i < count; i++) {
+        if (!swapState(seats[i], Seat::FREE, Seat::PURCHASED, generations[i])) {
+            // Purchased seats never change again, so the ones we took can simply be released;
+            // a sync may have seen them purchased in the meantime, so they are marked again
+            uint32_t generation;
+            for (int j = 0; j < i; j++) {
+                swapState(seats[j], Seat::PURCHASED, Seat::FREE, generation);
+                markDirty(seats[j]);
+            }
+
+            return false;
+        }
+    }
+
+    for (int i = 0; i < count; i++)
+        publish(seats[i], Seat::FREE, Seat::PURCHASED, generations[i]);
+
+    return true;
+}
+
+int BookingEngine::scanForRun(int n) const {
+    if (n <= 0 || n > cols) return -1;
+
+    for (int seat = count - 1, run = 0; seat >= 0; seat--) {
+        if (seat % cols == cols - 1) run = 0;
+
+        run = state(seat) == Seat::FREE ? run + 1 : 0;
+        if (run == n) return seat;
+    }
+
+    return -1;
+}
+
+bool BookingEngine::commitRun(int first, int n) {
+    std::atomic<uint32_t> &version = rowVersions[first / cols];
+
+    // Read phase: the run has to be free at an even (stable) version
+    uint32_t v = version.load(std::memory_order_acquire);
+    if (v & 1) return false;
+
+    for (int i = first; i < first + n; i++)
+        if (state(i) != Seat::FREE) return false;
+
+    // Validate: nobody touched the row since the read; take it for the write phase
+    if (!version.compare_exchange_strong(v, v + 1, std::memory_order_acq_rel))
+        return false;
+
+    // Write phase; a single-seat transition may still have slipped in after the validation
+    uint32_t generations[64];
+    std::vector<uint32_t> moreGenerations;
+    uint32_t *runGenerations = generations;
+    if (n > 64) {
+        moreGenerations.resize(n);
+        runGenerations = moreGenerations.data();
+    }
+
+    for (int i = 0; i < n; i++) {
+        if (!swapState(first + i, Seat::FREE, Seat::PURCHASED, runGenerations[i])) {
+            uint32_t generation;
+            for (int j = 0; j < i; j++) {
+                swapState(first + j, Seat::PURCHASED, Seat::FREE, generation);
+                markDirty(first + j);
+            }
+
+            version.fetch_add(1, std::memory_order_release);
+            return false;
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        markDirty(first + i);
+        if (journal) journal->append(first + i, Seat::FREE, Seat::PURCHASED, runGenerations[i]);
+    }
+
+    // Back to even; sync only reads a row between two equal even versions, so it sees
+    // the whole run or none of it
+    version.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+int BookingEngine::purchaseAdjacent(int n, const RunPicker &pick) {
+    for (int attempt = 0; attempt < MAX_TXN_ATTEMPTS; attempt++) {
+        if (attempt > 0) {
+            retries.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+
+        int first = pick ? pick(n) : scanForRun(n);
+        if (first == -1) return -1;
+
+        if (commitRun(first, n)) {
+            commits.fetch_add(1, std::memory_order_relaxed);
+            return first;
+        }
+
+        aborts.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return -1;
+}
+
+TxnStats BookingEngine::txnStats() const {
+    return {
+        commits.load(std::memory_order_relaxed),
+        aborts.load(std::memory_order_relaxed),
+        retries.load(std::memory_order_relaxed)
+    };
+}
+
+bool BookingEngine::sync(Hall &hall, std::vector<int> *changed) {
+    if (!anyDirty.exchange(false, std::memory_order_acquire)) return false;
+
+    syncSeats.clear();
+    for (int w = 0; w < dirtyWords; w++) {
+        uint64_t bits = dirty[w].exchange(0, std::memory_order_acquire);
+
+        for (int b = 0; bits; b++, bits >>= 1)
+            if (bits & 1) syncSeats.push_back(w * 64 + b);
+    }
+
+    bool any = false;
+
+    // Seats come out in order, so each row's seats are one stretch of the list
+    for (size_t first = 0, last; first < syncSeats.size(); first = last) {
+        int row = syncSeats[first] / cols;
+        for (last = first + 1; last < syncSeats.size() && syncSeats[last] / cols == row; last++) {}
+
+        // Read the row like a seqlock: an odd or moved version means a group commit overlapped
+        const std::atomic<uint32_t> &version = rowVersions[row];
+        uint32_t before = version.load(std::memory_order_acquire);
+
+        syncStates.clear();
+        for (size_t i = first; i < last; i++)
+            syncStates.push_back(state(syncSeats[i]));
+
+        if ((before & 1) || version.load(std::memory_order_acquire) != before) {
+            for (size_t i = first; i < last; i++)
+                markDirty(syncSeats[i]);
+            continue;
+        }
+
+        for (size_t i = first; i < last; i++) {
+            int seat = syncSeats[i];
+            unsigned char next = syncStates[i - first];
+            if (hall.states[seat] == next) continue;
+
+            hall.setState(seat, next);
+            any = true;
+            if (changed) changed->push_back(seat);
+        }
+    }
+
+    return any;
+}
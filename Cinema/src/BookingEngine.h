@@ -0,0 +1,87 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Hall.h"
+#include "Journal.h"
+
+struct TxnStats {
+    uint64_t commits, aborts, retries;
+};
+
+// Thread-safe source of truth for seat states. Every transition is a compare-and-swap
+// on the seat's atomic state, so any number of terminals can book the same hall.
+// The Hall (and its indices) is a main-thread view brought up to date by sync().
+class BookingEngine {
+public:
+    // Not safe while other threads are booking
+    void reset(const Hall &hall);
+
+    // Every successful transition (and reset) is appended to the journal
+    void attach(Journal *journal) { this->journal = journal; }
+
+    bool reserve(int seat);   // FREE -> RESERVED
+    bool cancel(int seat);    // RESERVED -> FREE
+    bool toggle(int seat);    // reserve a free seat or cancel a reserved one
+
+    // RESERVED -> FREE only if the seat has not changed since it was at `generation`, so an
+    // expiring hold can never cancel a later reservation of the same seat
+    bool expireHold(int seat, uint32_t generation);
+
+    // FREE -> PURCHASED for all seats or for none of them
+    bool purchase(const int *seats, int count);
+
+    // Returns the first seat of a run of n adjacent seats that look free, or -1
+    using RunPicker = std::function<int(int n)>;
+
+    // Optimistic group purchase: picks a run, then commits it only if its row's version
+    // has not moved, retrying on conflict. Without a picker the rows are scanned
+    // from the back like purchaseFirstNFreeSeats. Returns the first seat bought or -1.
+    int purchaseAdjacent(int n, const RunPicker &pick = nullptr);
+
+    TxnStats txnStats() const;
+
+    unsigned char state(int seat) const { return states[seat].load(std::memory_order_acquire) & 0xff; }
+    uint32_t generation(int seat) const { return states[seat].load(std::memory_order_acquire) >> 8; }
+    int size() const { return count; }
+
+    // Main thread: copies every seat changed since the last call into the hall, true if any did.
+    // The changed seats are appended to `changed` when given. A row in the middle of a group
+    // commit is left for the next call, so a run is never seen half bought.
+    bool sync(Hall &hall, std::vector<int> *changed = nullptr);
+
+private:
+    int count = 0, cols = 1;
+
+    // generation << 8 | state; the generation counts the seat's transitions since the
+    // last reset so the journal can order them no matter which thread appends first.
+    // It has 24 bits and wraps to 0 after 2^24 transitions of one seat without a reset.
+    std::unique_ptr<std::atomic<uint32_t>[]> states;
+
+    Journal *journal = nullptr;
+
+    // Bumped by 2 on every change in the row; odd while a group commit holds the row
+    std::unique_ptr<std::atomic<uint32_t>[]> rowVersions;
+
+    std::atomic<uint64_t> commits{ 0 }, aborts{ 0 }, retries{ 0 };
+
+    // One bit per seat changed since the last sync
+    int dirtyWords = 0;
+    std::unique_ptr<std::atomic<uint64_t>[]> dirty;
+    std::atomic<bool> anyDirty{ false };
+
+    // sync() scratch, main thread only
+    std::vector<int> syncSeats;
+    std::vector<unsigned char> syncStates;
+
+    bool transition(int seat, unsigned char from, unsigned char to);
+    bool swapState(int seat, unsigned char from, unsigned char to, uint32_t &generation);
+    void publish(int seat, unsigned char from, unsigned char to, uint32_t generation);
+    void markDirty(int seat);
+
+    int scanForRun(int n) const;
+    bool commitRun(int first, int n);
+};
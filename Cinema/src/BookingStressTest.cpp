@@ -0,0 +1,130 @@
+#include "BookingStressTest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "BookingEngine.h"
+#include "Hall.h"
+
+// Seats sold per seat, counted by the threads that got a purchase through
+static bool checkRound(const BookingEngine &booking, const Hall &hall, const std::vector<std::atomic<int>> &sold) {
+    bool ok = true;
+    int purchased = 0;
+
+    for (int seat = 0; seat < hall.size(); seat++) {
+        int sales = sold[seat].load();
+        unsigned char s = booking.state(seat);
+
+        if (sales > 1 || (sales == 1) != (s == Seat::PURCHASED)) {
+            std::cout << "Sediste " << seat << " prodato " << sales << " puta, stanje " << int(s) << std::endl;
+            ok = false;
+        }
+        if (hall.states[seat] != s) {
+            std::cout << "Sediste " << seat << ": sala " << int(hall.states[seat]) << ", sistem " << int(s) << std::endl;
+            ok = false;
+        }
+        purchased += s == Seat::PURCHASED;
+    }
+
+    if (hall.countPurchased() != purchased || hall.countFree() + hall.countReserved() + purchased != hall.size()) {
+        std::cout << "Brojaci sale se ne slazu sa stanjima sedista" << std::endl;
+        ok = false;
+    }
+
+    // the run index has to agree with the states it was synced from
+    for (int n = 1; n <= hall.cols; n++) {
+        bool exists = false;
+        for (int r = 0; r < hall.rows && !exists; r++)
+            for (int c = 0, run = 0; c < hall.cols && !exists; c++) {
+                run = hall.states[hall.index(r, c)] == Seat::FREE ? run + 1 : 0;
+                exists = run >= n;
+            }
+
+        int first = hall.findFreeRun(n);
+        bool valid = first != -1 && first % hall.cols + n <= hall.cols;
+        for (int i = first; valid && i < first + n; i++) valid = hall.states[i] == Seat::FREE;
+
+        if (exists != valid) {
+            std::cout << "Indeks slobodnih nizova gresi za " << n << " sedista" << std::endl;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+int runBookingStressTest(int threads, int rounds) {
+    constexpr int OPERATIONS = 20000;
+
+    HallLayout layout;
+    layout.rows = 6;
+    layout.cols = 12;
+    Hall hall = buildHall(layout);
+
+    BookingEngine booking;
+    std::vector<std::atomic<int>> sold(hall.size());
+    bool ok = true;
+
+    for (int round = 0; round < rounds && ok; round++) {
+        resetHall(hall);
+        booking.reset(hall);
+        for (auto &s : sold) s.store(0);
+
+        std::atomic<int> running{ threads };
+        std::vector<std::thread> terminals;
+        for (int t = 0; t < threads; t++) {
+            terminals.emplace_back([&, t] {
+                std::mt19937 rng(round * 1000 + t);
+                std::uniform_int_distribution<int> seatDist(0, hall.size() - 1), op(0, 9), groupSize(1, 4);
+
+                for (int i = 0; i < OPERATIONS; i++) {
+                    int k = op(rng);
+                    if (k < 4) {
+                        booking.reserve(seatDist(rng));
+                    }
+                    else if (k < 7) {
+                        booking.cancel(seatDist(rng));
+                    }
+                    else if (k < 9) {
+                        // a handful of seats around one spot, so groups overlap; each is
+                        // inserted in order, so only the n seats picked are ever touched
+                        int seats[4], n = groupSize(rng), base = seatDist(rng);
+                        for (int j = 0; j < n; j++) {
+                            int seat = (base + j * 3) % hall.size(), k = j;
+                            for (; k > 0 && seats[k - 1] > seat; k--) seats[k] = seats[k - 1];
+                            seats[k] = seat;
+                        }
+                        if (std::adjacent_find(seats, seats + n) != seats + n) continue;
+
+                        if (booking.purchase(seats, n))
+                            for (int j = 0; j < n; j++) sold[seats[j]]++;
+                    }
+                    else {
+                        int n = groupSize(rng);
+                        int first = booking.purchaseAdjacent(n);
+                        if (first != -1)
+                            for (int j = first; j < first + n; j++) sold[j]++;
+                    }
+                }
+                running--;
+            });
+        }
+
+        // the main thread keeps its view up to date while the terminals book
+        while (running.load() > 0) booking.sync(hall);
+        for (auto &t : terminals) t.join();
+        booking.sync(hall);
+
+        ok = checkRound(booking, hall, sold);
+    }
+
+    TxnStats txn = booking.txnStats();
+    std::cout << "Niti: " << threads << ", krugova: " << rounds << ", grupne kupovine: " << txn.commits << " uspesnih, "
+        << txn.aborts << " ponistenih" << std::endl;
+    std::cout << (ok ? "Nijedno sediste nije prodato dvaput, sala se slaze sa sistemom." : "Stres test NIJE prosao.") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+// Cinema.exe --stress-booking [threads]: terminals fighting over a small hall with reserve,
+// cancel, purchase and purchaseAdjacent while the main thread syncs. Checks that no seat was
+// sold twice and that the synced hall matches the engine; returns 0 when everything holds.
+int runBookingStressTest(int threads, int rounds);
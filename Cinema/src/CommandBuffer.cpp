@@ -0,0 +1,37 @@
+#include "CommandBuffer.h"
+
+#include <algorithm>
+
+#include "GLState.h"
+
+void CommandBuffer::record(DrawLayer layer, const ShaderProgram &shader, unsigned vao, bool blend, std::function<void()> draw) {
+    // layer 8 bits | shader 16 | VAO 16 | blend 1 | recording order 23
+    uint64_t key = static_cast<uint64_t>(layer) << 56
+        | static_cast<uint64_t>(shader.id() & 0xffff) << 40
+        | static_cast<uint64_t>(vao & 0xffff) << 24
+        | static_cast<uint64_t>(blend) << 23
+        | (packets.size() & 0x7fffff);
+
+    packets.push_back({ key, &shader, vao, blend, std::move(draw) });
+}
+
+int CommandBuffer::submit() {
+    // sort indices, the packets themselves stay put
+    order.clear();
+    for (size_t i = 0; i < packets.size(); i++)
+        order.emplace_back(packets[i].key, static_cast<int>(i));
+    std::sort(order.begin(), order.end());
+
+    for (const auto &entry : order) {
+        const DrawPacket &packet = packets[entry.second];
+
+        glState().blend(packet.blend);
+        packet.shader->use();
+        glState().bindVertexArray(packet.vao);
+        packet.draw();
+    }
+
+    const int submitted = static_cast<int>(packets.size());
+    packets.clear();
+    return submitted;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "ShaderProgram.h"
+
+// Back to front; draws in a lower layer always come first
+enum DrawLayer : uint8_t {
+    LAYER_CANVAS,
+    LAYER_SEATS,
+    LAYER_DOOR,
+    LAYER_COMPOSITE,
+    LAYER_CROWD,
+    LAYER_HUD_BACKGROUND,
+    LAYER_HUD_TEXT
+};
+
+// One draw: the state it needs and a callback that sets uniforms and issues the call
+struct DrawPacket {
+    uint64_t key;
+    const ShaderProgram *shader;
+    unsigned vao;
+    bool blend;
+    std::function<void()> draw;
+};
+
+// Subsystems record packets in any order; submit() sorts them by (layer, shader, VAO, blend)
+// and applies each packet's state through GLState, so equal state is bound once per run.
+// Within a layer packets may be reordered by state, so order-dependent draws need
+// different layers. Packets with the same key keep their recording order.
+class CommandBuffer {
+public:
+    void record(DrawLayer layer, const ShaderProgram &shader, unsigned vao, bool blend, std::function<void()> draw);
+
+    // Draws and clears everything recorded; returns the number of packets
+    int submit();
+
+private:
+    std::vector<DrawPacket> packets;
+    std::vector<std::pair<uint64_t, int>> order;
+};
@@ -0,0 +1,485 @@
+#include "Crowd.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CROWD_SSE2
+#include <emmintrin.h>
+#endif
+
+constexpr int Crowd::EVALUATE_GRAIN;
+constexpr float Crowd::STEP_SECONDS;
+constexpr int Crowd::CHECKPOINT_STEPS;
+
+void Crowd::spawn(const float *seatXs, const float *rowYs, int count, float doorXpos, float doorYpos,
+    float walkSpeed, double time, float interval) {
+    seatX.assign(seatXs, seatXs + count);
+    rowY.assign(rowYs, rowYs + count);
+    start.resize(count);
+    for (int i = 0; i < count; i++) start[i] = i * interval;
+
+    x.assign(count, doorXpos);
+    y.assign(count, doorYpos);
+    phase.assign(count, WALKING_IN);
+
+    epoch = time;
+    exitTime = std::numeric_limits<float>::max();
+    doorX = doorXpos;
+    doorY = doorYpos;
+    speed = walkSpeed;
+    walkingCount = count;
+    leaving = false;
+
+    progress.assign(count, 0.0f);
+    steps = 0;
+    admitted = 0;
+    savedCheckpoints = 0;
+}
+
+void Crowd::beginExit(double time) {
+    exitTime = static_cast<float>(time - epoch);
+    leaving = true;
+
+    // checkpoints past the exit were stepped as if nobody would ever leave
+    while (savedCheckpoints > 0 && checkpoints[savedCheckpoints - 1].steps * STEP_SECONDS > exitTime)
+        savedCheckpoints--;
+
+    // not known until the next evaluate(); until then nobody counts as gone
+    walkingCount = size();
+}
+
+void Crowd::clear() {
+    start.clear();
+    seatX.clear();
+    rowY.clear();
+    x.clear();
+    y.clear();
+    phase.clear();
+    progress.clear();
+    steps = 0;
+    admitted = 0;
+    savedCheckpoints = 0;
+
+    walkingCount = 0;
+    leaving = false;
+}
+
+void Crowd::setQueueing(float minGap) {
+    gap = minGap;
+}
+
+int Crowd::evaluate(double time) {
+    if (queueing()) return simulate(static_cast<float>(time - epoch), nullptr);
+
+    walkingCount = evaluateRange(static_cast<float>(time - epoch), 0, size());
+    return walkingCount;
+}
+
+int Crowd::evaluate(double time, JobSystem &jobs) {
+    if (queueing()) return simulate(static_cast<float>(time - epoch), &jobs);
+    if (jobs.threadCount() == 1 || size() <= EVALUATE_GRAIN) return evaluate(time);
+
+    const float t = static_cast<float>(time - epoch);
+    chunkCounts.assign(JobSystem::chunkCount(size(), EVALUATE_GRAIN), 0);
+
+    jobs.parallelFor(size(), EVALUATE_GRAIN, [&](int chunk, int begin, int end) {
+        chunkCounts[chunk] = evaluateRange(t, begin, end);
+    });
+
+    walkingCount = 0;
+    for (int c : chunkCounts) walkingCount += c;
+    return walkingCount;
+}
+
+int Crowd::evaluateRange(float t, int begin, int end) {
+    int stillWalking = 0;
+    int i = begin;
+
+    // Per agent, with d1 = |row - door y| and d2 = |seat - door x|:
+    //   in  = distance walked in by t, out = distance walked out, counted from the later of
+    //         the exit time and the agent's arrival (late arrivals sit down, then turn around)
+    //   in:  y = door y + sign * min(in, d1),        x = door x + sign * clamp(in - d1, 0, d2)
+    //   out: x = seat - sign * min(out, d2),         y = row - sign * clamp(out - d2, 0, d1)
+    //   phase = t >= exit start ? WALKING_OUT + (out >= d1 + d2) : (in >= d1 + d2)
+    // A finished leg selects its end point instead of adding up to it, so agents land exactly.
+#ifdef CROWD_SSE2
+    const __m128 vt = _mm_set1_ps(t), vSpeed = _mm_set1_ps(speed), vExit = _mm_set1_ps(exitTime);
+    const __m128 vDoorX = _mm_set1_ps(doorX), vDoorY = _mm_set1_ps(doorY), zero = _mm_setzero_ps();
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u)));
+    const __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+
+    for (; i + 4 <= end; i += 4) {
+        __m128 s = _mm_loadu_ps(&start[i]), sx = _mm_loadu_ps(&seatX[i]), ry = _mm_loadu_ps(&rowY[i]);
+
+        __m128 offY = _mm_sub_ps(ry, vDoorY), offX = _mm_sub_ps(sx, vDoorX);
+        __m128 d1 = _mm_and_ps(offY, absMask), d2 = _mm_and_ps(offX, absMask);
+        __m128 signY = _mm_and_ps(offY, signMask), signX = _mm_and_ps(offX, signMask);
+        __m128 total = _mm_add_ps(d1, d2);
+
+        __m128 in = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(vt, s), vSpeed), zero);
+        __m128 arrival = _mm_add_ps(s, _mm_div_ps(total, vSpeed));
+        __m128 out = _mm_max_ps(_mm_mul_ps(_mm_sub_ps(vt, _mm_max_ps(vExit, arrival)), vSpeed), zero);
+
+        // distances along each leg, then signed by the direction of travel
+        __m128 inY = _mm_min_ps(in, d1), inX = _mm_min_ps(_mm_max_ps(_mm_sub_ps(in, d1), zero), d2);
+        __m128 outX = _mm_min_ps(out, d2), outY = _mm_min_ps(_mm_max_ps(_mm_sub_ps(out, d2), zero), d1);
+
+        __m128 yIn = _mm_add_ps(vDoorY, _mm_or_ps(inY, signY)), xIn = _mm_add_ps(vDoorX, _mm_or_ps(inX, signX));
+        __m128 yOut = _mm_sub_ps(ry, _mm_or_ps(outY, signY)), xOut = _mm_sub_ps(sx, _mm_or_ps(outX, signX));
+
+        __m128 inRow = _mm_cmpge_ps(in, d1), inSeat = _mm_cmpge_ps(in, total);
+        __m128 outAisle = _mm_cmpge_ps(out, d2), outDoor = _mm_cmpge_ps(out, total);
+        yIn = _mm_or_ps(_mm_and_ps(inRow, ry), _mm_andnot_ps(inRow, yIn));
+        xIn = _mm_or_ps(_mm_and_ps(inSeat, sx), _mm_andnot_ps(inSeat, xIn));
+        xOut = _mm_or_ps(_mm_and_ps(outAisle, vDoorX), _mm_andnot_ps(outAisle, xOut));
+        yOut = _mm_or_ps(_mm_and_ps(outDoor, vDoorY), _mm_andnot_ps(outDoor, yOut));
+
+        __m128 isOut = _mm_cmpge_ps(vt, _mm_max_ps(vExit, arrival));
+        __m128 py = _mm_or_ps(_mm_and_ps(isOut, yOut), _mm_andnot_ps(isOut, yIn));
+        __m128 px = _mm_or_ps(_mm_and_ps(isOut, xOut), _mm_andnot_ps(isOut, xIn));
+
+        __m128i outI = _mm_castps_si128(isOut);
+        __m128i seated = _mm_and_si128(_mm_castps_si128(inSeat), one);
+        __m128i left = _mm_and_si128(_mm_castps_si128(outDoor), one);
+        __m128i p = _mm_or_si128(_mm_and_si128(outI, _mm_or_si128(two, left)), _mm_andnot_si128(outI, seated));
+
+        _mm_storeu_ps(&x[i], px);
+        _mm_storeu_ps(&y[i], py);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&phase[i]), p);
+
+        // even phase = still walking
+        int walkingMask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(p, one), _mm_setzero_si128())));
+        stillWalking += (walkingMask & 1) + (walkingMask >> 1 & 1) + (walkingMask >> 2 & 1) + (walkingMask >> 3 & 1);
+    }
+#endif
+
+    // the same formulas, one agent at a time (tail, or everything without SSE2)
+    for (; i < end; i++) {
+        float offY = rowY[i] - doorY, offX = seatX[i] - doorX;
+        float d1 = std::abs(offY), d2 = std::abs(offX), total = d1 + d2;
+
+        float in = std::max((t - start[i]) * speed, 0.0f);
+        float arrival = start[i] + total / speed;
+        float out = std::max((t - std::max(exitTime, arrival)) * speed, 0.0f);
+
+        float inY = std::min(in, d1), inX = std::min(std::max(in - d1, 0.0f), d2);
+        float outX = std::min(out, d2), outY = std::min(std::max(out - d2, 0.0f), d1);
+
+        float yIn = in >= d1 ? rowY[i] : doorY + std::copysign(inY, offY);
+        float xIn = in >= total ? seatX[i] : doorX + std::copysign(inX, offX);
+        float xOut = out >= d2 ? doorX : seatX[i] - std::copysign(outX, offX);
+        float yOut = out >= total ? doorY : rowY[i] - std::copysign(outY, offY);
+
+        bool isOut = t >= std::max(exitTime, arrival);
+        y[i] = isOut ? yOut : yIn;
+        x[i] = isOut ? xOut : xIn;
+        phase[i] = isOut ? WALKING_OUT + (out >= total) : (in >= total);
+
+        stillWalking += (phase[i] & 1) ^ 1;
+    }
+
+    return stillWalking;
+}
+
+int Crowd::writePositions(float *out, int max) const {
+    int written = 0;
+    for (int i = 0; i < size() && written < max; i++) {
+        out[written * 2] = x[i];
+        out[written * 2 + 1] = y[i];
+        written += phase[i] != LEFT;   // overwritten by the next agent when skipped
+    }
+    return written;
+}
+
+int Crowd::countInside(int begin, int end) const {
+    int inside = 0;
+    for (int i = begin; i < end; i++) inside += phase[i] != LEFT;
+    return inside;
+}
+
+int Crowd::writePositions(float *out, int max, JobSystem &jobs) const {
+    if (jobs.threadCount() == 1 || size() <= EVALUATE_GRAIN) return writePositions(out, max);
+
+    // count per chunk, turn the counts into offsets, then every chunk writes its own slice
+    int chunks = JobSystem::chunkCount(size(), EVALUATE_GRAIN);
+    chunkCounts.assign(chunks, 0);
+    jobs.parallelFor(size(), EVALUATE_GRAIN, [&](int chunk, int begin, int end) {
+        chunkCounts[chunk] = countInside(begin, end);
+    });
+
+    int total = 0;
+    for (int &c : chunkCounts) {
+        int inside = c;
+        c = total;
+        total += inside;
+    }
+
+    jobs.parallelFor(size(), EVALUATE_GRAIN, [&](int chunk, int begin, int end) {
+        int written = chunkCounts[chunk];
+        for (int i = begin; i < end && written < max; i++) {
+            if (phase[i] == LEFT) continue;
+            out[written * 2] = x[i];
+            out[written * 2 + 1] = y[i];
+            written++;
+        }
+    });
+    return std::min(total, max);
+}
+
+int Crowd::simulate(float t, JobSystem *jobs) {
+    const Checkpoint *resume = checkpointBefore(t);
+    if (resume && (t < steps * STEP_SECONDS || resume->steps > steps)) restore(*resume);
+    else if (t < steps * STEP_SECONDS) restart();
+
+    while ((steps + 1) * STEP_SECONDS <= t) {
+        step(steps * STEP_SECONDS, jobs);
+        steps++;
+
+        // stepping is deterministic, so a checkpoint saved once stays valid after a rewind
+        if (steps % CHECKPOINT_STEPS == 0 && (savedCheckpoints == 0 || steps > checkpoints[savedCheckpoints - 1].steps))
+            saveCheckpoint();
+    }
+    return walkingCount;
+}
+
+void Crowd::saveCheckpoint() {
+    if (static_cast<int>(checkpoints.size()) == savedCheckpoints) checkpoints.emplace_back();
+
+    Checkpoint &c = checkpoints[savedCheckpoints++];
+    c.steps = steps;
+    c.admitted = admitted;
+    c.walkingCount = walkingCount;
+    c.progress.assign(progress.begin(), progress.end());
+    c.x.assign(x.begin(), x.end());
+    c.y.assign(y.begin(), y.end());
+    c.phase.assign(phase.begin(), phase.end());
+}
+
+// The last checkpoint at or before t, or null
+const Crowd::Checkpoint *Crowd::checkpointBefore(float t) const {
+    auto later = std::upper_bound(checkpoints.begin(), checkpoints.begin() + savedCheckpoints, t,
+        [](float time, const Checkpoint &c) { return time < c.steps * STEP_SECONDS; });
+    return later == checkpoints.begin() ? nullptr : &*(later - 1);
+}
+
+void Crowd::restore(const Checkpoint &c) {
+    steps = c.steps;
+    admitted = c.admitted;
+    walkingCount = c.walkingCount;
+    std::copy(c.progress.begin(), c.progress.end(), progress.begin());
+    std::copy(c.x.begin(), c.x.end(), x.begin());
+    std::copy(c.y.begin(), c.y.end(), y.begin());
+    std::copy(c.phase.begin(), c.phase.end(), phase.begin());
+}
+
+void Crowd::restart() {
+    std::fill(progress.begin(), progress.end(), 0.0f);
+    std::fill(x.begin(), x.end(), doorX);
+    std::fill(y.begin(), y.end(), doorY);
+    std::fill(phase.begin(), phase.end(), static_cast<int32_t>(WALKING_IN));
+
+    steps = 0;
+    admitted = 0;
+    walkingCount = size();
+}
+
+void Crowd::heading(int i, float &dx, float &dy) const {
+    float offY = rowY[i] - doorY, offX = seatX[i] - doorX;
+
+    // in: up the aisle, then along the row; out: the same path back
+    bool vertical = phase[i] == WALKING_IN ? progress[i] < std::abs(offY) : progress[i] >= std::abs(offX);
+    float turn = phase[i] == WALKING_IN ? 1.0f : -1.0f;
+
+    if (vertical) {
+        dx = 0;
+        dy = turn * std::copysign(1.0f, offY);
+    }
+    else {
+        dx = turn * std::copysign(1.0f, offX);
+        dy = 0;
+    }
+}
+
+void Crowd::place(int i) {
+    float offY = rowY[i] - doorY, offX = seatX[i] - doorX;
+    float d1 = std::abs(offY), d2 = std::abs(offX), total = d1 + d2;
+    float s = std::min(progress[i], total);
+
+    // the closed-form legs, with the distance walked instead of the time
+    if (phase[i] == WALKING_IN) {
+        x[i] = s < d1 ? doorX : s >= total ? seatX[i] : doorX + std::copysign(s - d1, offX);
+        y[i] = s < d1 ? doorY + std::copysign(s, offY) : rowY[i];
+        if (progress[i] >= total) phase[i] = SEATED;
+    }
+    else {
+        x[i] = s < d2 ? seatX[i] - std::copysign(s, offX) : doorX;
+        y[i] = s < d2 ? rowY[i] : s >= total ? doorY : rowY[i] - std::copysign(s - d2, offY);
+        if (progress[i] >= total) phase[i] = LEFT;
+    }
+}
+
+bool Crowd::doorClear() const {
+    bool clear = true;
+    neighbours.forEachNear(doorX, doorY, [&](int j) {
+        float rx = x[j] - doorX, ry = y[j] - doorY;
+        if (rx * rx + ry * ry < gap * gap) clear = false;
+    });
+    return clear;
+}
+
+void Crowd::step(float now, JobSystem *jobs) {
+    const int n = size();
+    const bool exitStarted = now >= exitTime;
+
+    // seated ones get up once the screening is over, those still outside stay outside
+    moving.clear();
+    int seated = 0;
+    for (int i = 0; i < n; i++) {
+        if (exitStarted) {
+            if (phase[i] == SEATED) {
+                phase[i] = WALKING_OUT;
+                progress[i] = 0;
+            }
+            else if (i >= admitted && phase[i] == WALKING_IN) {
+                phase[i] = LEFT;
+            }
+        }
+        if (i < admitted && (phase[i] & 1) == 0) moving.push_back(i);
+        seated += phase[i] == SEATED;
+    }
+
+    // anyone more than one cell away is further than the gap plus this step's walk
+    const float reach = speed * STEP_SECONDS;
+    const int count = static_cast<int>(moving.size());
+    neighbours.build(x.data(), y.data(), moving.data(), count, gap + reach);
+
+    // the door lets the next one in once the last one has made room
+    bool entered = false;
+    if (!exitStarted && admitted < n && now >= start[admitted] && doorClear()) {
+        admitted++;
+        entered = true;
+    }
+
+    // Everyone walks as far as they can without getting closer than the gap to someone in
+    // front of them, judged by where everybody stood after the last step. Oncoming people
+    // pass each other; of two crossing paths in front of each other the lower index goes first.
+    nextProgress.resize(n);
+    auto advance = [&](int, int begin, int end) {
+        for (int k = begin; k < end; k++) {
+            int i = moving[k];
+            float dx, dy;
+            heading(i, dx, dy);
+
+            float walk = reach;
+            neighbours.forEachNear(x[i], y[i], [&](int j) {
+                if (j == i) return;
+                float rx = x[j] - x[i], ry = y[j] - y[i];
+                float ahead = rx * dx + ry * dy, lateral = std::abs(rx * dy - ry * dx);
+                if (lateral >= gap * 0.5f || ahead < 0 || (ahead == 0 && j > i)) return;
+
+                float jx, jy;
+                heading(j, jx, jy);
+                float along = dx * jx + dy * jy;
+                if (along < -0.5f) return;
+                if (along < 0.5f && j > i && -(rx * jx + ry * jy) >= 0 && std::abs(rx * jy - ry * jx) < gap * 0.5f) return;
+
+                walk = std::min(walk, std::max(ahead - gap, 0.0f));
+            });
+            nextProgress[i] = progress[i] + walk;
+        }
+    };
+
+    const int chunks = jobs ? JobSystem::chunkCount(count, EVALUATE_GRAIN) : 1;
+    chunkCounts.assign(chunks, 0);
+    auto apply = [&](int chunk, int begin, int end) {
+        int stillWalking = 0;
+        for (int k = begin; k < end; k++) {
+            int i = moving[k];
+            progress[i] = nextProgress[i];
+            place(i);
+            stillWalking += leaving ? phase[i] != LEFT : (phase[i] & 1) ^ 1;
+        }
+        chunkCounts[chunk] = stillWalking;
+    };
+
+    if (jobs) {
+        jobs->parallelFor(count, EVALUATE_GRAIN, advance);
+        jobs->parallelFor(count, EVALUATE_GRAIN, apply);
+    }
+    else {
+        advance(0, 0, count);
+        apply(0, 0, count);
+    }
+
+    // on their feet inside, plus the one who just came in and everyone still waiting outside;
+    // once leaving, the seated too (the steps can be just short of the exit time)
+    walkingCount = entered + (exitStarted ? 0 : n - admitted) + (leaving ? seated : 0);
+    for (int c : chunkCounts) walkingCount += c;
+}
+
+int runCrowdBenchmark(int agents, float gap) {
+    using Clock = std::chrono::steady_clock;
+
+    // seats spread over the lower half of the screen, door on the left like in the hall
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> sx(-0.9f, 0.9f), sy(-0.85f, 0.0f);
+    std::vector<float> seatX(agents), seatY(agents);
+    for (int i = 0; i < agents; i++) {
+        seatX[i] = sx(rng);
+        seatY[i] = sy(rng);
+    }
+
+    // 75 frames a second until everyone is in, then out again; every frame also packs the
+    // positions for upload, like the renderer does. Queueing, how long that takes matters too.
+    const double frame = 1.0 / 75.0;
+    std::vector<float> positions(agents * 2);
+
+    auto walk = [&](JobSystem *jobs, const std::string &label) {
+        Crowd crowd;
+        crowd.setQueueing(gap);
+        crowd.spawn(seatX.data(), seatY.data(), agents, -0.99f, 0.2f, 0.75f, 0.0, 0.0f);
+
+        long long evaluations = 0;
+        double time = 0;
+        auto step = [&] {
+            int walking = jobs ? crowd.evaluate(time, *jobs) : crowd.evaluate(time);
+            if (jobs) crowd.writePositions(positions.data(), agents, *jobs);
+            else crowd.writePositions(positions.data(), agents);
+            time += frame;
+            evaluations++;
+            return walking;
+        };
+
+        auto begin = Clock::now();
+        while (step() > 0) {}
+        const double seatedAt = time;
+        crowd.beginExit(time);
+        while (step() > 0) {}
+        double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+        std::cout << label << ": kadrova: " << evaluations << (gap > 0 ? ", kadar: " : ", kadar (ili skok na bilo koje vreme): ")
+            << seconds * 1000.0 / std::max(1LL, evaluations) << " ms ("
+            << static_cast<uint64_t>(agents * evaluations / seconds) << " osoba/s)" << std::endl;
+        std::cout << "  svi sede posle " << seatedAt << " s, sala prazna posle " << time - seatedAt << " s" << std::endl;
+    };
+
+    std::cout << "Osoba: " << agents;
+    if (gap > 0) std::cout << ", u redu na razmaku " << gap;
+    std::cout << std::endl;
+    walk(nullptr, "Jedna nit");
+
+    JobSystem jobs;
+    walk(&jobs, "Niti: " + std::to_string(jobs.threadCount()));
+
+    JobStats stats = jobs.stats();
+    std::cout << "Poslova: " << stats.jobs << ", ukradeno: " << stats.steals << std::endl;
+    return 0;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "SpatialHash.h"
+
+class JobSystem;
+
+// Time for the crowd: follows the wall clock, but can be paused and moved
+struct CrowdClock {
+    double base = 0, realBase = 0;
+    bool paused = false;
+
+    double now(double real) const { return paused ? base : base + (real - realBase); }
+    void pause(double real) { base = now(real); realBase = real; paused = true; }
+    void resume(double real) { realBase = real; paused = false; }
+    void seek(double real, double delta) { base = now(real) + delta; realBase = real; }
+};
+
+// Moviegoers as a structure of arrays. Everyone walks at constant speed vertically to their
+// row first, then horizontally to their seat, and leaves by the same path in reverse (along
+// the row back to the door's aisle, then to the door). Position is therefore a closed-form
+// function of time: only the start time, row y and seat x are stored, and evaluate() computes
+// every agent's position and phase for any moment, so a seek costs the same as a normal frame.
+// The evaluation is the same arithmetic for every agent, four at a time where SSE2 is available,
+// and agents don't depend on each other, so the overloads taking a JobSystem split the arrays
+// into chunks of EVALUATE_GRAIN agents for the workers.
+//
+// With queueing on, agents get in each other's way: they come in through the door one at a
+// time and keep a minimum gap to whoever walks ahead of them in the same direction, so the
+// door, the aisle and the rows form queues. That is no longer a function of time alone;
+// evaluate() steps the crowd in fixed steps up to the requested time. A checkpoint is kept every
+// CHECKPOINT_STEPS steps and a seek resumes from the last one before the target, so a seek back
+// (or forward over time already stepped) replays at most that many steps.
+// Every step looks for neighbours in a spatial hash, so it stays O(n).
+class Crowd {
+public:
+    // agents per chunk, so even a 3000-seat hall splits six ways; a multiple of 4 keeps
+    // chunks on SSE2 groups
+    static constexpr int EVALUATE_GRAIN = 512;
+    static constexpr float STEP_SECONDS = 1.0f / 120.0f;
+    static constexpr int CHECKPOINT_STEPS = 240;
+
+    enum Phase : int32_t {
+        WALKING_IN = 0,
+        SEATED = 1,
+        WALKING_OUT = 2,
+        LEFT = 3      // walking phases are the even ones
+    };
+
+    // trajectory, per agent; start is relative to the spawn time
+    std::vector<float> start, seatX, rowY;
+
+    // evaluated at the last evaluate() time
+    std::vector<float> x, y;
+    std::vector<int32_t> phase;
+
+    // Everyone enters through the door, one every `interval` seconds from `time`
+    void spawn(const float *seatXs, const float *rowYs, int count, float doorX, float doorY,
+        float speed, double time, float interval);
+    // From `time` on, everyone heads for the door (once they have reached their seat)
+    void beginExit(double time);
+    void clear();
+
+    // Minimum distance between agents walking the same way; 0 walks everyone freely
+    void setQueueing(float gap);
+    bool queueing() const { return gap > 0; }
+
+    // Positions and phases at `time`; returns how many agents are still walking
+    int evaluate(double time);
+    int evaluate(double time, JobSystem &jobs);
+
+    int size() const { return static_cast<int>(x.size()); }
+    int walking() const { return walkingCount; }
+    bool exiting() const { return leaving; }
+    bool allSeated() const { return !leaving && walkingCount == 0; }
+    bool allLeft() const { return leaving && walkingCount == 0; }
+
+    // x, y pairs of everyone still inside; returns how many were written (at most `max`)
+    int writePositions(float *out, int max) const;
+    int writePositions(float *out, int max, JobSystem &jobs) const;
+
+private:
+    double epoch = 0;           // spawn time; per-agent times are floats relative to it
+    float exitTime = 0;         // relative to epoch, huge until beginExit
+    float doorX = 0, doorY = 0, speed = 1;
+    int walkingCount = 0;
+    bool leaving = false;
+
+    // queueing: distance walked along the current way (in or out), agents [0, admitted) are inside
+    float gap = 0;
+    std::vector<float> progress, nextProgress;
+    std::vector<int> moving;
+    SpatialHash neighbours;
+    int steps = 0, admitted = 0;
+
+    // the queueing state every CHECKPOINT_STEPS steps, in step order
+    struct Checkpoint {
+        int steps, admitted, walkingCount;
+        std::vector<float> progress, x, y;
+        std::vector<int32_t> phase;
+    };
+    std::vector<Checkpoint> checkpoints;
+    int savedCheckpoints = 0;   // the rest of the vector is kept for its storage
+
+    // per-chunk counts of the parallel paths
+    mutable std::vector<int> chunkCounts;
+
+    int evaluateRange(float t, int begin, int end);
+    int countInside(int begin, int end) const;
+
+    int simulate(float t, JobSystem *jobs);
+    void restart();
+    void saveCheckpoint();
+    const Checkpoint *checkpointBefore(float t) const;
+    void restore(const Checkpoint &c);
+    void step(float now, JobSystem *jobs);
+    void place(int i);
+    void heading(int i, float &dx, float &dy) const;
+    bool doorClear() const;
+};
+
+// Cinema.exe --bench-crowd [agents] [gap]: times evaluation over a whole walk in and out, on
+// one thread and then on the job system; with a gap, the queueing crowd and how long it takes
+int runCrowdBenchmark(int agents, float gap);
@@ -0,0 +1,61 @@
+#include "CrowdRenderer.h"
+
+#include "GLState.h"
+
+void CrowdRenderer::init(const SeatMesh &icon, const StreamBuffer &stream) {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBOmesh);
+    glGenBuffers(1, &EBO);
+
+    glState().bindVertexArray(VAO);
+
+    glState().bindArrayBuffer(VBOmesh);
+    glBufferData(GL_ARRAY_BUFFER, icon.vertices.size() * sizeof(float), icon.vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, icon.indices.size() * sizeof(unsigned), icon.indices.data(), GL_STATIC_DRAW);
+    indexCount = static_cast<int>(icon.indices.size());
+    mode = icon.mode;
+
+    // Position, advanced once per instance; the offset moves every frame
+    glState().bindArrayBuffer(stream.buffer());
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(1);
+
+    glState().bindVertexArray(0);
+}
+
+void CrowdRenderer::upload(const Crowd &crowd, StreamBuffer &stream, JobSystem &jobs) {
+    instanceCount = 0;
+    if (crowd.size() == 0) return;
+
+    StreamAllocation allocation = stream.allocate(crowd.size() * 2 * sizeof(float), 2 * sizeof(float));
+    if (!allocation) return;
+
+    instanceCount = crowd.writePositions(static_cast<float*>(allocation.ptr), crowd.size(), jobs);
+
+    // no base instance in GL 3.3, so the attribute itself points at this frame's data
+    glState().bindVertexArray(VAO);
+    glState().bindArrayBuffer(stream.buffer());
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)allocation.offset);
+}
+
+void CrowdRenderer::draw(const ShaderProgram &shader, float size, const float color[4]) const {
+    if (instanceCount == 0) return;
+
+    shader.use();
+    shader.setVec2("uScale", size, size);
+    shader.setVec4("uColor", color);
+
+    // the figure's parts are fans split by the restart index, like the seats
+    glEnable(GL_PRIMITIVE_RESTART);
+    glPrimitiveRestartIndex(SeatMesh::RESTART);
+
+    glState().bindVertexArray(VAO);
+    glDrawElementsInstanced(mode, indexCount, GL_UNSIGNED_INT, (void*)0, instanceCount);
+
+    glDisable(GL_PRIMITIVE_RESTART);
+}
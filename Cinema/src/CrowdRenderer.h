@@ -0,0 +1,23 @@
+#pragma once
+#include <GL/glew.h>
+
+#include "Crowd.h"
+#include "JobSystem.h"
+#include "SeatMesh.h"
+#include "ShaderProgram.h"
+#include "StreamBuffer.h"
+
+// Everyone still in the hall as one instanced draw of a small figure (makePersonMesh).
+// Positions are rewritten into the stream buffer every frame the crowd is drawn.
+struct CrowdRenderer {
+    unsigned VAO = 0, VBOmesh = 0, EBO = 0;
+    int indexCount = 0;
+    GLenum mode = GL_TRIANGLE_FAN;
+    int instanceCount = 0;
+
+    void init(const SeatMesh &icon, const StreamBuffer &stream);
+
+    // Call between the stream's beginFrame and flush; the positions are packed by the workers
+    void upload(const Crowd &crowd, StreamBuffer &stream, JobSystem &jobs);
+    void draw(const ShaderProgram &shader, float size, const float color[4]) const;
+};
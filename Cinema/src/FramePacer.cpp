@@ -0,0 +1,125 @@
+#include "FramePacer.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+// weight of the newest sleep in the estimate, roughly the last 50 sleeps count
+constexpr double SLEEP_ESTIMATE_WEIGHT = 0.02;
+
+FramePacer::FramePacer(PacingOptions options)
+    : options(options), periodSeconds(1.0 / (options.targetHz > 0 ? options.targetHz : 75.0)) {}
+
+void FramePacer::begin() {
+    glfwSwapInterval(options.mode == PacingMode::VSYNC ? 1 : 0);
+
+#ifdef _WIN32
+    // default scheduler tick is 15.6 ms, longer than a whole 75 Hz frame
+    if (options.mode != PacingMode::VSYNC) timeBeginPeriod(1);
+#endif
+
+    startTime = lastFrame = glfwGetTime();
+    deadline = startTime + periodSeconds;
+}
+
+void FramePacer::end() {
+#ifdef _WIN32
+    if (options.mode != PacingMode::VSYNC) timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::sleepUntil(double target, bool spinTail) {
+    double now = glfwGetTime();
+
+    if (!spinTail) {
+        if (target > now)
+            std::this_thread::sleep_for(std::chrono::duration<double>(target - now));
+        return;
+    }
+
+    // 1 ms sleeps while the remaining time clearly exceeds what a sleep may overshoot by
+    while (true) {
+        double estimate = sleepMean + std::sqrt(sleepVariance);
+        if (target - now <= estimate) break;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        double after = glfwGetTime();
+        double observed = after - now;
+        now = after;
+
+        // follows changes in system load without growing with the number of samples
+        double delta = observed - sleepMean;
+        sleepMean += SLEEP_ESTIMATE_WEIGHT * delta;
+        sleepVariance = (1 - SLEEP_ESTIMATE_WEIGHT) * (sleepVariance + SLEEP_ESTIMATE_WEIGHT * delta * delta);
+    }
+
+    double spinStart = now;
+    while (now < target) now = glfwGetTime();
+    spinSeconds += now - spinStart;
+}
+
+void FramePacer::record(double now) {
+    double interval = now - lastFrame;
+    lastFrame = now;
+
+    frames++;
+    if (interval > periodSeconds * 1.5) missed++;
+    if (interval > worst) worst = interval;
+
+    double delta = interval - intervalMean;
+    intervalMean += delta / frames;
+    intervalM2 += delta * (interval - intervalMean);
+}
+
+void FramePacer::wait() {
+    if (options.mode != PacingMode::VSYNC)
+        sleepUntil(deadline, options.mode == PacingMode::HYBRID);
+
+    double now = glfwGetTime();
+    record(now);
+
+    // a late frame starts a new schedule instead of rushing to catch up
+    deadline += periodSeconds;
+    if (deadline < now) deadline = now + periodSeconds;
+}
+
+void FramePacer::resume() {
+    lastFrame = glfwGetTime();
+    deadline = lastFrame + periodSeconds;
+}
+
+PacingStats FramePacer::stats() const {
+    PacingStats s;
+    s.frames = frames;
+    s.missed = missed;
+    s.meanMs = intervalMean * 1000.0;
+    s.jitterMs = frames > 1 ? std::sqrt(intervalM2 / (frames - 1)) * 1000.0 : 0;
+    s.worstMs = worst * 1000.0;
+
+    double elapsed = lastFrame - startTime;
+    s.spinFraction = elapsed > 0 ? spinSeconds / elapsed : 0;
+    return s;
+}
+
+PacingOptions parsePacingOptions(const std::string &mode, const std::string &fps, const std::string &render) {
+    PacingOptions options;
+
+    if (mode == "vsync") options.mode = PacingMode::VSYNC;
+    else if (mode == "sleep") options.mode = PacingMode::SLEEP;
+    else if (mode == "hybrid") options.mode = PacingMode::HYBRID;
+
+    double hz = std::atof(fps.c_str());
+    if (hz > 0) options.targetHz = hz;
+
+    options.redrawOnChange = render != "always";
+    return options;
+}
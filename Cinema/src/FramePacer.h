@@ -0,0 +1,62 @@
+#pragma once
+#include <GLFW/glfw3.h>
+#include <string>
+
+enum class PacingMode {
+    VSYNC,   // glfwSwapInterval(1), the swap blocks until the display refresh
+    SLEEP,   // sleep until the deadline, cheapest but overshoots by the OS timer slack
+    HYBRID   // sleep while far from the deadline, then spin the last stretch
+};
+
+struct PacingOptions {
+    PacingMode mode = PacingMode::HYBRID;
+    double targetHz = 75.0;
+    bool redrawOnChange = true;   // idle in glfwWaitEventsTimeout until something changes
+};
+
+struct PacingStats {
+    long long frames = 0;
+    long long missed = 0;         // frames that took longer than 1.5 periods
+    double meanMs = 0;            // mean frame interval
+    double jitterMs = 0;          // standard deviation of the frame interval
+    double worstMs = 0;
+    double spinFraction = 0;      // share of wall time spent spinning in wait()
+};
+
+// Holds the main loop to a fixed rate without burning a core between frames.
+// Call wait() once per frame after glfwSwapBuffers; main thread only.
+class FramePacer {
+public:
+    explicit FramePacer(PacingOptions options = PacingOptions());
+
+    void begin();   // sets the swap interval and the timer resolution, needs a current context
+    void end();
+
+    void wait();
+    void resume();  // after idling outside the pacer; the idle time is not counted as a frame
+
+    PacingStats stats() const;
+
+private:
+    PacingOptions options;
+    double periodSeconds;
+
+    double deadline = 0;
+    double lastFrame = 0;
+    double startTime = 0;
+    double spinSeconds = 0;
+
+    // running estimate of how long a 1 ms sleep really takes, for HYBRID: exponentially
+    // weighted mean and variance, so old samples fade out and the spread stays bounded
+    double sleepMean = 0.001, sleepVariance = 0;
+
+    long long frames = 0, missed = 0;
+    double intervalMean = 0, intervalM2 = 0, worst = 0;
+
+    void sleepUntil(double target, bool spinTail);
+    void record(double now);
+};
+
+// Values of Cinema.exe [--pacing vsync|sleep|hybrid] [--fps N] [--render always|changes];
+// an empty or unknown value keeps the default
+PacingOptions parsePacingOptions(const std::string &mode, const std::string &fps, const std::string &render);
@@ -0,0 +1,100 @@
+#include "FreeRunIndex.h"
+
+#include <algorithm>
+
+#include "Hall.h"
+
+static int nextPowerOfTwo(int n) {
+    int p = 1;
+    while (p < n) p *= 2;
+    return p;
+}
+
+// Combines two children that each cover len seats
+static FreeRunIndex::Node merge(const FreeRunIndex::Node &L, const FreeRunIndex::Node &R, int len) {
+    return {
+        L.prefix == len ? len + R.prefix : L.prefix,
+        R.suffix == len ? len + L.suffix : R.suffix,
+        std::max({ L.best, R.best, L.suffix + R.prefix })
+    };
+}
+
+void FreeRunIndex::build(int rows, int cols, const unsigned char *states) {
+    this->rows = rows;
+    this->cols = cols;
+    colLeaves = nextPowerOfTwo(cols);
+    rowLeaves = nextPowerOfTwo(rows);
+
+    buildTrees(nullptr);
+    freeNodes = nodes;
+    freeRowBest = rowBest;
+
+    buildTrees(states);
+}
+
+void FreeRunIndex::reset() {
+    nodes = freeNodes;
+    rowBest = freeRowBest;
+}
+
+// states == nullptr builds the trees of an all-free hall
+void FreeRunIndex::buildTrees(const unsigned char *states) {
+    // Padding leaves count as taken, so runs never extend past the last column
+    nodes.assign(rows * 2 * colLeaves, Node{ 0, 0, 0 });
+    rowBest.assign(2 * rowLeaves, 0);
+
+    for (int r = 0; r < rows; r++) {
+        Node *tree = rowTree(r);
+
+        for (int c = 0; c < cols; c++) {
+            int f = !states || states[r * cols + c] == Seat::FREE ? 1 : 0;
+            tree[colLeaves + c] = { f, f, f };
+        }
+
+        // Level by level from the leaves; nodes first..2*first-1 have children of len seats
+        for (int len = 1, first = colLeaves / 2; first >= 1; len *= 2, first /= 2)
+            for (int i = first; i < 2 * first; i++)
+                tree[i] = merge(tree[2 * i], tree[2 * i + 1], len);
+
+        rowBest[rowLeaves + r] = tree[1].best;
+    }
+
+    for (int i = rowLeaves - 1; i >= 1; i--)
+        rowBest[i] = std::max(rowBest[2 * i], rowBest[2 * i + 1]);
+}
+
+void FreeRunIndex::set(int seat, bool free) {
+    int r = seat / cols, c = seat % cols;
+    Node *tree = rowTree(r);
+
+    int f = free ? 1 : 0;
+    int i = colLeaves + c;
+    tree[i] = { f, f, f };
+
+    // Children of the node at i / 2 each cover len seats
+    for (int len = 1; i > 1; len *= 2) {
+        i /= 2;
+        tree[i] = merge(tree[2 * i], tree[2 * i + 1], len);
+    }
+
+    pullRow(r);
+}
+
+void FreeRunIndex::pullRow(int r) {
+    int i = rowLeaves + r;
+    rowBest[i] = rowTree(r)[1].best;
+
+    for (i /= 2; i >= 1; i /= 2)
+        rowBest[i] = std::max(rowBest[2 * i], rowBest[2 * i + 1]);
+}
+
+int FreeRunIndex::findRow(int n) const {
+    if (n <= 0 || rows == 0 || rowBest[1] < n) return -1;
+
+    // Rearmost row first: prefer the right child
+    int i = 1;
+    while (i < rowLeaves)
+        i = rowBest[2 * i + 1] >= n ? 2 * i + 1 : 2 * i;
+
+    return i - rowLeaves;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <vector>
+
+// Longest run of free seats per row: one segment tree per row and a max tree over
+// the rows, so finding a row with N adjacent free seats and updating a seat are both O(log seats).
+class FreeRunIndex {
+public:
+    void build(int rows, int cols, const unsigned char *states);
+    void set(int seat, bool free);
+
+    // Back to an all-free hall by copying the trees saved in build
+    void reset();
+
+    // Rearmost row with n adjacent free seats, or -1 if there is none
+    int findRow(int n) const;
+
+    struct Node {
+        int prefix, suffix, best;
+    };
+
+private:
+    int rows = 0, cols = 0;
+    int colLeaves = 1, rowLeaves = 1;
+
+    std::vector<Node> nodes;     // rows trees of 2 * colLeaves nodes, root at 1
+    std::vector<int> rowBest;    // max tree over the roots of the row trees
+
+    std::vector<Node> freeNodes;
+    std::vector<int> freeRowBest;
+
+    void buildTrees(const unsigned char *states);
+
+    Node *rowTree(int r) { return &nodes[r * 2 * colLeaves]; }
+    const Node *rowTree(int r) const { return &nodes[r * 2 * colLeaves]; }
+
+    void pullRow(int r);
+};
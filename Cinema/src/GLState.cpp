@@ -0,0 +1,66 @@
+#include "GLState.h"
+
+GLState &glState() {
+    static GLState state;
+    return state;
+}
+
+void GLState::useProgram(unsigned p) {
+    if (p == program) { current.skippedPrograms++; return; }
+    glUseProgram(p);
+    program = p;
+    current.issued++;
+}
+
+void GLState::bindVertexArray(unsigned v) {
+    if (v == vao) { current.skippedVertexArrays++; return; }
+    glBindVertexArray(v);
+    vao = v;
+    current.issued++;
+}
+
+void GLState::bindArrayBuffer(unsigned b) {
+    if (b == arrayBuffer) { current.skippedBuffers++; return; }
+    glBindBuffer(GL_ARRAY_BUFFER, b);
+    arrayBuffer = b;
+    current.issued++;
+}
+
+void GLState::blend(bool enabled) {
+    if (blendEnabled == static_cast<int>(enabled)) { current.skippedBlend++; return; }
+    if (enabled) glEnable(GL_BLEND);
+    else glDisable(GL_BLEND);
+    blendEnabled = enabled;
+    current.issued++;
+}
+
+void GLState::blendFunc(GLenum src, GLenum dst) {
+    if (src == blendSrc && dst == blendDst) { current.skippedBlend++; return; }
+    glBlendFunc(src, dst);
+    blendSrc = src;
+    blendDst = dst;
+    current.issued++;
+}
+
+void GLState::deleteVertexArray(unsigned v) {
+    glDeleteVertexArrays(1, &v);
+    if (v == vao) vao = 0;
+}
+
+void GLState::deleteBuffer(unsigned b) {
+    glDeleteBuffers(1, &b);
+    if (b == arrayBuffer) arrayBuffer = 0;
+}
+
+void GLState::endFrame() {
+    lastFrame = current;
+
+    totals.issued += current.issued;
+    totals.skippedPrograms += current.skippedPrograms;
+    totals.skippedVertexArrays += current.skippedVertexArrays;
+    totals.skippedBuffers += current.skippedBuffers;
+    totals.skippedBlend += current.skippedBlend;
+
+    current = GLStateCounts();
+    frameCount++;
+}
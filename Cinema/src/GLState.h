@@ -0,0 +1,43 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstdint>
+
+// Calls the tracker saw in the last finished frame, or summed over the whole run
+struct GLStateCounts {
+    uint64_t issued = 0;
+    uint64_t skippedPrograms = 0, skippedVertexArrays = 0, skippedBuffers = 0, skippedBlend = 0;
+
+    uint64_t skipped() const { return skippedPrograms + skippedVertexArrays + skippedBuffers + skippedBlend; }
+};
+
+// Remembers the bound program, VAO, array buffer and blend state, and drops calls that would
+// not change them. Every module binds through it; a bind made around it leaves the cache stale.
+// Element array buffers belong to the VAO and are bound directly.
+class GLState {
+public:
+    void useProgram(unsigned program);
+    void bindVertexArray(unsigned vao);
+    void bindArrayBuffer(unsigned buffer);
+    void blend(bool enabled);
+    void blendFunc(GLenum src, GLenum dst);
+
+    // Names can be reused after deletion, so the cache has to forget them
+    void deleteVertexArray(unsigned vao);
+    void deleteBuffer(unsigned buffer);
+
+    // Closes the frame's counts; frame() returns them until the next endFrame()
+    void endFrame();
+    const GLStateCounts &frame() const { return lastFrame; }
+    const GLStateCounts &total() const { return totals; }
+    long long frames() const { return frameCount; }
+
+private:
+    unsigned program = 0, vao = 0, arrayBuffer = 0;
+    int blendEnabled = -1;   // unknown until first set
+    GLenum blendSrc = 0, blendDst = 0;
+
+    GLStateCounts current, lastFrame, totals;
+    long long frameCount = 0;
+};
+
+GLState &glState();
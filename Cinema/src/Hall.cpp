@@ -0,0 +1,157 @@
+#include "Hall.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static void layOutGrid(const HallLayout &layout, HallGeometry &geometry) {
+    // 5x10 hall keeps the original spacing, bigger halls shrink to fit
+    float spacing = std::min({ 0.08f * 2.2f, layout.maxWidth / layout.cols, layout.maxHeight / layout.rows });
+    geometry.seatSize = spacing / 2.2f;
+
+    float totalWidth = layout.cols * spacing;
+    float startX = -totalWidth / 2.0f + spacing / 2.0f;
+
+    float totalHeight = layout.rows * spacing;
+    float startY = layout.centerY + totalHeight / 2.0f - spacing / 2.0f;
+
+    int n = layout.rows * layout.cols;
+    geometry.xs.resize(n);
+    geometry.ys.resize(n);
+
+    for (int r = 0; r < layout.rows; r++) {
+        for (int c = 0; c < layout.cols; c++) {
+            geometry.xs[r * layout.cols + c] = startX + c * spacing;
+            geometry.ys[r * layout.cols + c] = startY - r * spacing;
+        }
+    }
+}
+
+std::shared_ptr<const HallGeometry> buildHallGeometry(const HallLayout &layout) {
+    auto geometry = std::make_shared<HallGeometry>();
+    geometry->rows = layout.rows;
+    geometry->cols = layout.cols;
+
+    if (layout.imported()) {
+        geometry->seatSize = layout.seatSize;
+        geometry->xs = layout.xs;
+        geometry->ys = layout.ys;
+    }
+    else {
+        layOutGrid(layout, *geometry);
+    }
+
+    // Imported positions can be anything, so only generated halls get the uniform grid
+    geometry->seatIndex.build(geometry->xs.data(), geometry->ys.data(), layout.rows * layout.cols, geometry->seatSize, !layout.imported());
+
+    return geometry;
+}
+
+Hall makeHall(std::shared_ptr<const HallGeometry> geometry) {
+    Hall hall;
+    hall.rows = geometry->rows;
+    hall.cols = geometry->cols;
+    hall.geometry = std::move(geometry);
+
+    hall.states.assign(hall.size(), Seat::FREE);
+    hall.freeRuns.build(hall.rows, hall.cols, hall.states.data());
+    hall.bits.build(hall.rows, hall.cols, hall.states.data());
+    hall.occupied.build(hall.size(), hall.states.data());
+
+    return hall;
+}
+
+Hall buildHall(const HallLayout &layout) {
+    return makeHall(buildHallGeometry(layout));
+}
+
+void resetHall(Hall &hall) {
+    std::memset(hall.states.data(), Seat::FREE, hall.states.size());
+    hall.freeRuns.reset();
+    hall.bits.reset();
+    hall.occupied.reset();
+}
+
+void Hall::setState(int seat, unsigned char state) {
+    unsigned char was = states[seat];
+    states[seat] = state;
+
+    if ((was == Seat::FREE) != (state == Seat::FREE))
+        freeRuns.set(seat, state == Seat::FREE);
+    bits.set(seat, state);
+    occupied.set(seat, was, state);
+}
+
+int Hall::findFreeRun(int n) const {
+    // The index picks the row, the bitplane kernel finds the run inside it
+    int r = freeRuns.findRow(n);
+    if (r == -1) return -1;
+
+    return index(r, bits.findRunInRow(r, n));
+}
+
+std::string hallLayoutKey(const HallLayout &layout) {
+    std::string key = std::to_string(layout.rows) + "x" + std::to_string(layout.cols);
+    if (!layout.imported()) return key;
+
+    // FNV-1a over the seat size and every position
+    uint32_t hash = 2166136261u;
+    auto mix = [&](const void *data, size_t bytes) {
+        const unsigned char *p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; i++) hash = (hash ^ p[i]) * 16777619u;
+    };
+    mix(&layout.seatSize, sizeof(float));
+    mix(layout.xs.data(), layout.xs.size() * sizeof(float));
+    mix(layout.ys.data(), layout.ys.size() * sizeof(float));
+
+    char hex[9];
+    std::snprintf(hex, sizeof(hex), "%08x", hash);
+    return key + "-" + hex;
+}
+
+// Format: "rows cols seatSize" followed by "x y" for every seat, row by row
+bool loadHallLayout(const char *filePath, HallLayout &layout) {
+    std::ifstream file(filePath);
+    HallLayout loaded;
+
+    if (!(file >> loaded.rows >> loaded.cols >> loaded.seatSize) || loaded.rows <= 0 || loaded.cols <= 0) {
+        std::cout << "Raspored sale nije ucitan! Putanja rasporeda: " << filePath << std::endl;
+        return false;
+    }
+
+    int n = loaded.rows * loaded.cols;
+    loaded.xs.resize(n);
+    loaded.ys.resize(n);
+
+    for (int i = 0; i < n; i++) {
+        if (!(file >> loaded.xs[i] >> loaded.ys[i])) {
+            std::cout << "Raspored sale nije potpun! Putanja rasporeda: " << filePath << std::endl;
+            return false;
+        }
+    }
+
+    layout = loaded;
+    return true;
+}
+
+HallLayout parseHallLayout(int argc, char **argv) {
+    HallLayout layout;
+
+    // Cinema.exe [rows cols] or Cinema.exe [layout file]
+    if (argc == 2) {
+        loadHallLayout(argv[1], layout);
+    }
+    else if (argc >= 3) {
+        int rows = std::atoi(argv[1]), cols = std::atoi(argv[2]);
+        if (rows > 0 && cols > 0) {
+            layout.rows = rows;
+            layout.cols = cols;
+        }
+    }
+
+    return layout;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FreeRunIndex.h"
+#include "OccupiedSeats.h"
+#include "SeatBits.h"
+#include "SeatIndex.h"
+
+struct Seat {
+    enum State : unsigned char { FREE, RESERVED, PURCHASED };
+};
+
+// Describes a hall before it is laid out; rows and cols can come from the command line.
+// An imported layout also gives every seat's position, row by row.
+struct HallLayout {
+    int rows = 5, cols = 10;
+    float centerY = -0.4f;
+    float maxWidth = 1.76f, maxHeight = 0.88f;
+
+    float seatSize = 0;
+    std::vector<float> xs, ys;
+
+    bool imported() const { return !xs.empty(); }
+};
+
+// Where the seats are: computed once per layout, never changes, shared by every hall using it.
+// Seat i is at row i / cols and column i % cols.
+struct HallGeometry {
+    int rows = 0, cols = 0;
+    float seatSize = 0;
+
+    std::vector<float> xs, ys;
+    SeatIndex seatIndex;
+};
+
+// What the seats are: a flat state array plus the indices derived from it
+struct Hall {
+    std::shared_ptr<const HallGeometry> geometry;
+    int rows = 0, cols = 0;
+
+    std::vector<unsigned char> states;
+
+    FreeRunIndex freeRuns;
+    SeatBits bits;
+    OccupiedSeats occupied;
+
+    int size() const { return rows * cols; }
+    int index(int r, int c) const { return r * cols + c; }
+
+    int seatAt(double mx, double my) const { return geometry->seatIndex.queryPoint(mx, my); }
+    void seatsIn(double x0, double y0, double x1, double y1, std::vector<int> &out) const { geometry->seatIndex.queryRect(x0, y0, x1, y1, out); }
+
+    // All state changes go through here so the indices stay in sync
+    void setState(int seat, unsigned char state);
+
+    // First seat of the rightmost n adjacent free seats in the rearmost row that has them, or -1
+    int findFreeRun(int n) const;
+
+    int countFree() const { return size() - occupied.size(); }
+    int countReserved() const { return occupied.reserved(); }
+    int countPurchased() const { return occupied.purchased(); }
+};
+
+std::shared_ptr<const HallGeometry> buildHallGeometry(const HallLayout &layout);
+Hall makeHall(std::shared_ptr<const HallGeometry> geometry);
+Hall buildHall(const HallLayout &layout);
+
+// Every seat back to FREE: one memset of the states, bulk copies of the all-free indices and
+// a pass over the occupied seats
+void resetHall(Hall &hall);
+
+// Names a layout for the files that belong to it: rows x cols, plus a hash of the
+// positions for an imported layout
+std::string hallLayoutKey(const HallLayout &layout);
+
+bool loadHallLayout(const char *filePath, HallLayout &layout);
+HallLayout parseHallLayout(int argc, char **argv);
@@ -0,0 +1,188 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+constexpr int64_t JobDeque::CAPACITY;
+
+bool JobDeque::push(Job *job) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= CAPACITY) return false;
+
+    slots[b % CAPACITY].store(job, std::memory_order_relaxed);
+    bottom.store(b + 1, std::memory_order_seq_cst);
+    return true;
+}
+
+Job *JobDeque::pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_seq_cst);
+
+    if (t > b) {
+        // empty
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job *job = slots[b % CAPACITY].load(std::memory_order_relaxed);
+    if (t == b) {
+        // last one: race the thieves for it
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job *JobDeque::steal() {
+    int64_t t = top.load(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_seq_cst);
+    if (t >= b) return nullptr;
+
+    Job *job = slots[t % CAPACITY].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return job;
+}
+
+JobSystem::JobSystem(int workers) {
+    if (workers < 0) workers = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+
+    for (int i = 0; i <= workers; i++)
+        deques.emplace_back(new JobDeque());
+}
+
+void JobSystem::startWorkers() {
+    for (int i = 1; i < threadCount(); i++)
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+
+    for (auto &t : threads) t.join();
+}
+
+void JobSystem::enqueue(Job *job, int self) {
+    if (!deques[self]->push(job)) {
+        execute(job, self);
+        return;
+    }
+
+    queued.fetch_add(1);
+    if (sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wake.notify_all();
+    }
+}
+
+void JobSystem::execute(Job *job, int self) {
+    // split until one chunk is left, the upper halves go up for stealing
+    while (job->last - job->first > 1) {
+        int mid = job->first + (job->last - job->first) / 2;
+
+        Job *upper = &jobPool[nextJob.fetch_add(1)];
+        upper->first = mid;
+        upper->last = job->last;
+        job->last = mid;
+
+        enqueue(upper, self);
+    }
+
+    int chunk = job->first;
+    int begin = chunk * batchGrain, end = std::min(batchCount, begin + batchGrain);
+    chunkFn(chunkCtx, chunk, begin, end);
+
+    jobsRun.fetch_add(1, std::memory_order_relaxed);
+    pendingChunks.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+Job *JobSystem::find(int self) {
+    Job *job = deques[self]->pop();
+    if (job) {
+        queued.fetch_sub(1);
+        return job;
+    }
+
+    // everyone else's, starting past ourselves so thieves spread over victims
+    int n = threadCount();
+    for (int k = 1; k < n; k++) {
+        job = deques[(self + k) % n]->steal();
+        if (job) {
+            queued.fetch_sub(1);
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::run(int count, int grain, ChunkFn fn, void *ctx) {
+    int chunks = chunkCount(count, grain);
+    if (chunks == 0) return;
+
+    // nothing to share, or nobody to share with
+    if (chunks == 1 || threadCount() == 1) {
+        for (int c = 0; c < chunks; c++)
+            fn(ctx, c, c * grain, std::min(count, (c + 1) * grain));
+        return;
+    }
+
+    if (threads.empty()) startWorkers();
+
+    chunkFn = fn;
+    chunkCtx = ctx;
+    batchCount = count;
+    batchGrain = grain;
+
+    // every split makes one job, so a batch never needs more than one per chunk
+    if (static_cast<int>(jobPool.size()) < chunks) jobPool.resize(chunks);
+    nextJob.store(1);
+    pendingChunks.store(chunks, std::memory_order_release);
+    batches.fetch_add(1, std::memory_order_relaxed);
+
+    Job *root = &jobPool[0];
+    root->first = 0;
+    root->last = chunks;
+    enqueue(root, 0);
+
+    while (pendingChunks.load(std::memory_order_acquire) > 0) {
+        Job *job = find(0);
+        if (job) execute(job, 0);
+        else std::this_thread::yield();
+    }
+}
+
+void JobSystem::workerLoop(int self) {
+    int idleSpins = 0;
+
+    while (!stopping.load()) {
+        Job *job = find(self);
+        if (job) {
+            execute(job, self);
+            idleSpins = 0;
+            continue;
+        }
+
+        // stay hot for a moment (the next split or the next frame's batch), then sleep
+        if (++idleSpins < 64) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepers.fetch_add(1);
+        wake.wait(lock, [&] { return stopping.load() || queued.load() > 0; });
+        sleepers.fetch_sub(1);
+        idleSpins = 0;
+    }
+}
+
+JobStats JobSystem::stats() const {
+    return { batches.load(), jobsRun.load(), steals.load() };
+}
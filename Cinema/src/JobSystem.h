@@ -0,0 +1,93 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A range of chunks [first, last) of one parallelFor
+struct Job {
+    int first, last;
+};
+
+// Chase-Lev deque: the owning thread pushes and pops at the bottom, any thread steals from
+// the top. Fixed capacity; a full deque refuses the push and the owner runs the job itself.
+class JobDeque {
+public:
+    static constexpr int64_t CAPACITY = 4096;
+
+    bool push(Job *job);
+    Job *pop();
+    Job *steal();
+
+private:
+    std::atomic<int64_t> top{ 0 }, bottom{ 0 };
+    std::atomic<Job*> slots[CAPACITY];
+};
+
+struct JobStats {
+    uint64_t batches, jobs, steals;
+};
+
+// Worker threads with a deque each, plus one for the thread that submits work (the main
+// thread). parallelFor hands the whole range to the submitter's deque as one job; whoever runs
+// a job larger than one chunk splits off its upper half onto its own deque and keeps the
+// lower half, so idle threads steal big pieces first and the work spreads by itself.
+// The submitting thread works too until the batch is done. The workers are started by the
+// first batch that has more than one chunk, so a program that never splits work never runs them.
+class JobSystem {
+public:
+    // workers < 0: one per hardware thread besides the submitting one
+    explicit JobSystem(int workers = -1);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem &operator=(const JobSystem&) = delete;
+
+    int threadCount() const { return static_cast<int>(deques.size()); }
+    static int chunkCount(int count, int grain) { return grain > 0 ? (count + grain - 1) / grain : 0; }
+
+    // Calls fn(chunk, begin, end) for every grain-sized piece of [0, count) and returns when
+    // all have run. Only from the thread that created the system, never from inside a job.
+    template <class F>
+    void parallelFor(int count, int grain, F &&fn) {
+        using Fn = typename std::remove_reference<F>::type;
+        run(count, grain, [](void *ctx, int chunk, int begin, int end) {
+            (*static_cast<Fn*>(ctx))(chunk, begin, end);
+        }, const_cast<void*>(static_cast<const void*>(&fn)));
+    }
+
+    JobStats stats() const;
+
+private:
+    using ChunkFn = void (*)(void *ctx, int chunk, int begin, int end);
+
+    std::vector<std::unique_ptr<JobDeque>> deques;   // 0 is the submitting thread's
+    std::vector<std::thread> threads;
+
+    // the batch being run
+    ChunkFn chunkFn = nullptr;
+    void *chunkCtx = nullptr;
+    int batchCount = 0, batchGrain = 1;
+    std::vector<Job> jobPool;
+    std::atomic<int> nextJob{ 0 };
+    std::atomic<int> pendingChunks{ 0 };
+
+    // sleeping workers wake when something is queued
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<int> queued{ 0 }, sleepers{ 0 };
+    std::atomic<bool> stopping{ false };
+
+    std::atomic<uint64_t> batches{ 0 }, jobsRun{ 0 }, steals{ 0 };
+
+    void startWorkers();
+    void run(int count, int grain, ChunkFn fn, void *ctx);
+    void execute(Job *job, int self);
+    Job *find(int self);
+    void enqueue(Job *job, int self);
+    void workerLoop(int self);
+};
@@ -0,0 +1,302 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "Journal.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+#ifdef _WIN32
+#include <io.h>
+static void syncFile(FILE *f) { fflush(f); _commit(_fileno(f)); }
+#else
+#include <unistd.h>
+static void syncFile(FILE *f) { fflush(f); fsync(fileno(f)); }
+#endif
+
+constexpr uint32_t
+JOURNAL_MAGIC = 0x4c4e4a43,    // "CJNL"
+SNAPSHOT_MAGIC = 0x504e5343;   // "CSNP"
+
+static uint8_t checksum(const JournalRecord &r) {
+    const uint8_t *bytes = reinterpret_cast<const uint8_t*>(&r);
+    uint8_t sum = 0;
+    for (size_t i = 0; i < offsetof(JournalRecord, check); i++) sum += bytes[i];
+
+    // A zero-filled torn tail must not pass
+    return sum ^ 0xa5;
+}
+
+static void applyRecord(const JournalRecord &r, std::vector<unsigned char> &states, std::vector<uint32_t> &generations) {
+    if (r.type == Journal::RESET) {
+        std::fill(states.begin(), states.end(), static_cast<unsigned char>(Seat::FREE));
+        std::fill(generations.begin(), generations.end(), 0);
+        return;
+    }
+
+    // Appends from different threads can reach the journal out of order; the generation can't
+    if (r.seat < states.size() && r.generation > generations[r.seat]) {
+        generations[r.seat] = r.generation;
+        states[r.seat] = r.to;
+    }
+}
+
+static bool readSnapshot(const std::string &path, int seats, std::vector<unsigned char> &states, std::vector<uint32_t> &generations) {
+    FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    uint32_t header[2];
+    bool ok = std::fread(header, sizeof(header), 1, f) == 1 &&
+        header[0] == SNAPSHOT_MAGIC && header[1] == static_cast<uint32_t>(seats) &&
+        std::fread(states.data(), 1, seats, f) == static_cast<size_t>(seats) &&
+        std::fread(generations.data(), sizeof(uint32_t), seats, f) == static_cast<size_t>(seats);
+
+    std::fclose(f);
+    return ok;
+}
+
+bool recoverJournal(const std::string &basePath, int seats, std::vector<unsigned char> &states, std::vector<uint32_t> &generations) {
+    states.assign(seats, Seat::FREE);
+    generations.assign(seats, 0);
+
+    // A crash between removing the old snapshot and renaming the new one leaves only .tmp;
+    // replaying the whole journal on top of either is safe because replay is idempotent
+    bool recovered = readSnapshot(basePath + ".snapshot", seats, states, generations) ||
+        readSnapshot(basePath + ".snapshot.tmp", seats, states, generations);
+    if (!recovered) {
+        states.assign(seats, Seat::FREE);
+        generations.assign(seats, 0);
+    }
+
+    FILE *f = std::fopen((basePath + ".journal").c_str(), "rb");
+    if (!f) return recovered;
+
+    uint32_t header[2];
+    if (std::fread(header, sizeof(header), 1, f) == 1 && header[0] == JOURNAL_MAGIC && header[1] == static_cast<uint32_t>(seats)) {
+        recovered = true;
+
+        // Stop at the first torn or corrupt record
+        JournalRecord buffer[4096];
+        size_t n;
+        bool torn = false;
+        while (!torn && (n = std::fread(buffer, sizeof(JournalRecord), 4096, f)) > 0) {
+            for (size_t i = 0; i < n; i++) {
+                if (buffer[i].check != checksum(buffer[i])) {
+                    torn = true;
+                    break;
+                }
+                applyRecord(buffer[i], states, generations);
+            }
+        }
+    }
+
+    std::fclose(f);
+    return recovered;
+}
+
+// Files that don't describe this hall are kept under another name instead of being overwritten
+static void setAside(const std::string &path) {
+    FILE *f = std::fopen(path.c_str(), "rb");
+    if (!f) return;
+    std::fclose(f);
+
+    std::string old = path + ".old";
+    std::remove(old.c_str());
+    if (std::rename(path.c_str(), old.c_str()) == 0)
+        std::cout << "Dnevnik ne odgovara ovoj sali, sacuvan je kao " << old << std::endl;
+}
+
+bool Journal::open(const std::string &basePath, Hall &hall) {
+    close();
+
+    snapshotPath = basePath + ".snapshot";
+    journalPath = basePath + ".journal";
+    seats = hall.size();
+
+    std::vector<uint32_t> generations;
+    bool recovered = recoverJournal(basePath, seats, mirrorStates, generations);
+
+    if (recovered) {
+        for (int i = 0; i < seats; i++)
+            hall.setState(i, mirrorStates[i]);
+    }
+    else {
+        setAside(snapshotPath);
+        setAside(snapshotPath + ".tmp");
+        setAside(journalPath);
+    }
+
+    // Nothing is booking yet, so generations can start over from the compacted snapshot
+    mirrorGenerations.assign(seats, 0);
+    if (!writeSnapshot() || !startJournalFile()) {
+        std::cout << "Dnevnik rezervacija nije otvoren! Putanja: " << journalPath << std::endl;
+        return recovered;
+    }
+
+    stopping = false;
+    writer = std::thread(&Journal::writerLoop, this);
+    return recovered;
+}
+
+void Journal::close() {
+    if (!writer.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+
+    std::fclose(file);
+    file = nullptr;
+}
+
+void Journal::push(const JournalRecord &record) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!writer.joinable() || stopping) return;
+
+        pending.push_back(record);
+        appended++;
+    }
+    wake.notify_one();
+}
+
+void Journal::append(int seat, unsigned char from, unsigned char to, uint32_t generation) {
+    JournalRecord r = { static_cast<uint32_t>(seat), generation, TRANSITION, from, to, 0 };
+    r.check = checksum(r);
+    push(r);
+}
+
+void Journal::appendReset() {
+    JournalRecord r = { static_cast<uint32_t>(seats), 0, RESET, 0, 0, 0 };
+    r.check = checksum(r);
+    push(r);
+}
+
+void Journal::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = appended;
+    flushed.wait(lock, [&] { return durable >= target || !writer.joinable(); });
+}
+
+JournalStats Journal::stats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+void Journal::writerLoop() {
+    std::vector<JournalRecord> batch;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;) {
+        wake.wait(lock, [&] { return !pending.empty() || stopping; });
+        if (pending.empty()) break;
+
+        // Everything queued while the previous batch was being synced goes out together
+        batch.swap(pending);
+        uint64_t upTo = appended;
+        lock.unlock();
+
+        std::fwrite(batch.data(), sizeof(JournalRecord), batch.size(), file);
+        syncFile(file);
+
+        for (const JournalRecord &r : batch)
+            applyRecord(r, mirrorStates, mirrorGenerations);
+
+        sinceSnapshot += batch.size();
+        bool snapshot = sinceSnapshot >= snapshotInterval;
+        if (snapshot) {
+            writeSnapshot();
+            startJournalFile();
+        }
+
+        lock.lock();
+        durable = upTo;
+        counters.events += batch.size();
+        counters.batches++;
+        if (snapshot) counters.snapshots++;
+        batch.clear();
+
+        flushed.notify_all();
+    }
+}
+
+bool Journal::writeSnapshot() {
+    std::string tmpPath = snapshotPath + ".tmp";
+    FILE *f = std::fopen(tmpPath.c_str(), "wb");
+    if (!f) return false;
+
+    uint32_t header[2] = { SNAPSHOT_MAGIC, static_cast<uint32_t>(seats) };
+    std::fwrite(header, sizeof(header), 1, f);
+    std::fwrite(mirrorStates.data(), 1, seats, f);
+    std::fwrite(mirrorGenerations.data(), sizeof(uint32_t), seats, f);
+    syncFile(f);
+    std::fclose(f);
+
+    std::remove(snapshotPath.c_str());
+    std::rename(tmpPath.c_str(), snapshotPath.c_str());
+
+    sinceSnapshot = 0;
+    return true;
+}
+
+bool Journal::startJournalFile() {
+    if (file) std::fclose(file);
+
+    file = std::fopen(journalPath.c_str(), "wb");
+    if (!file) return false;
+
+    uint32_t header[2] = { JOURNAL_MAGIC, static_cast<uint32_t>(seats) };
+    std::fwrite(header, sizeof(header), 1, file);
+    syncFile(file);
+    return true;
+}
+
+int runJournalBenchmark(const std::string &basePath, int events) {
+    using Clock = std::chrono::steady_clock;
+    constexpr int THREADS = 4;
+
+    std::remove((basePath + ".snapshot").c_str());
+    std::remove((basePath + ".journal").c_str());
+
+    HallLayout layout;
+    layout.rows = 50;
+    layout.cols = 60;
+    Hall hall = buildHall(layout);
+
+    Journal journal;
+    journal.snapshotInterval = UINT64_MAX;   // keep the whole log for the recovery timing
+    journal.open(basePath, hall);
+
+    auto start = Clock::now();
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < THREADS; t++) {
+        producers.emplace_back([&, t] {
+            for (int i = t; i < events; i += THREADS)
+                journal.append(i % hall.size(), Seat::FREE, Seat::RESERVED, i / hall.size() + 1);
+        });
+    }
+    for (auto &p : producers) p.join();
+    journal.flush();
+
+    double appendSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    JournalStats stats = journal.stats();
+    journal.close();
+
+    start = Clock::now();
+    std::vector<unsigned char> states;
+    std::vector<uint32_t> generations;
+    recoverJournal(basePath, hall.size(), states, generations);
+    double recoverSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::cout << "Dogadjaja: " << stats.events << ", grupnih upisa (fsync): " << stats.batches << std::endl;
+    std::cout << "Upis: " << static_cast<uint64_t>(stats.events / appendSeconds) << " dogadjaja/s" << std::endl;
+    std::cout << "Oporavak: " << recoverSeconds * 1000.0 << " ms" << std::endl;
+
+    std::remove((basePath + ".snapshot").c_str());
+    std::remove((basePath + ".journal").c_str());
+    return 0;
+}
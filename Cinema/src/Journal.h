@@ -0,0 +1,78 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Hall.h"
+
+// One seat state transition (or a hall reset) as written to disk
+struct JournalRecord {
+    uint32_t seat;
+    uint32_t generation;   // per-seat transition counter; replay keeps the highest one
+    uint8_t type, from, to, check;
+};
+
+struct JournalStats {
+    uint64_t events, batches, snapshots;
+};
+
+// Append-only journal of seat transitions. Appends from any thread are queued and a
+// writer thread commits them in groups, one fsync per batch. Every snapshotInterval
+// events it writes a snapshot and starts the journal over, so recovery reads one
+// snapshot plus a short tail.
+class Journal {
+public:
+    enum Type : uint8_t { TRANSITION = 1, RESET = 2 };
+
+    ~Journal() { close(); }
+
+    // Rebuilds the hall from basePath.snapshot + basePath.journal if they describe a hall
+    // of the same size, then compacts them into a fresh snapshot and starts the writer.
+    // Returns false if nothing was recovered.
+    bool open(const std::string &basePath, Hall &hall);
+    void close();
+
+    void append(int seat, unsigned char from, unsigned char to, uint32_t generation);
+    void appendReset();
+
+    // Blocks until everything appended so far is on disk
+    void flush();
+
+    JournalStats stats();
+
+    uint64_t snapshotInterval = 100000;
+
+private:
+    std::string snapshotPath, journalPath;
+    FILE *file = nullptr;
+    int seats = 0;
+
+    std::mutex mutex;
+    std::condition_variable wake, flushed;
+    std::vector<JournalRecord> pending;
+    uint64_t appended = 0, durable = 0;
+    bool stopping = false;
+    std::thread writer;
+
+    // Writer thread only: the state the journal on disk describes, for snapshots
+    std::vector<unsigned char> mirrorStates;
+    std::vector<uint32_t> mirrorGenerations;
+    uint64_t sinceSnapshot = 0;
+
+    JournalStats counters = { 0, 0, 0 };
+
+    void push(const JournalRecord &record);
+    void writerLoop();
+    bool writeSnapshot();
+    bool startJournalFile();
+};
+
+// Snapshot plus journal tail into states/generations (sized to seats); false if there is neither
+bool recoverJournal(const std::string &basePath, int seats, std::vector<unsigned char> &states, std::vector<uint32_t> &generations);
+
+// Appends `events` records from several threads and times the appends and a full recovery
+int runJournalBenchmark(const std::string &basePath, int events);
@@ -1,15 +1,40 @@
 ﻿#include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <iostream>
 #include <random>
 
-#define STB_EASY_FONT_IMPLEMENTATION
-#include "stb_easy_font.h"
-
 #include "Util.h"
+#include "Hall.h"
+#include "BookingEngine.h"
+#include "BookingStressTest.h"
+#include "Journal.h"
+#include "ReservationHolds.h"
+#include "SeatRenderer.h"
+#include "TextCache.h"
+#include "FramePacer.h"
+#include "Redraw.h"
+#include "StaticLayer.h"
+#include "ShaderProgram.h"
+#include "GLState.h"
+#include "CommandBuffer.h"
+#include "StreamBuffer.h"
+#include "Crowd.h"
+#include "CrowdRenderer.h"
+#include "JobSystem.h"
+#include "Options.h"
 
 constexpr double
-MIN_FRAME_DURATION_SECONDS = 1.0 / 75.0,
-PROJECTION_DURATION_SECONDS = 20.0;
+PROJECTION_DURATION_SECONDS = 20.0,
+HOLD_DURATION_SECONDS = 120.0,
+IDLE_WAKE_SECONDS = 0.25;
+
+constexpr float
+PERSON_SPEED = 0.75f,   // NDC per second
+PERSON_SIZE = 0.04f,
+PERSON_GAP = 0.04f,     // between people queueing, centre to centre
+PERSON_ENTRY_INTERVAL = 0.3f,
+CROWD_SEEK_SECONDS = 2.0f;
 
 constexpr int
 CANVAS_COLOUR_DURATION_FRAMES = 20;
@@ -17,26 +42,23 @@ CANVAS_COLOUR_DURATION_FRAMES = 20;
 GLFWcursor *cursor, *cursorPressed;
 int width = 800, height = 800;
 
-double projectionEndTime = -1.0;
+// Enter -> people walk in -> door closes, film -> door opens, people walk out -> back to idle
+enum class Screening { IDLE, ENTERING, FILM, EXITING };
+Screening screening = Screening::IDLE;
+double filmEndTime = -1.0, exitDeadline = -1.0;   // exitDeadline on the crowd clock
 float cR(1), cB(1), cG(1);
 
-constexpr int ROWS = 5, COLS = 10;
-
-struct Seat {
-    enum State { FREE, RESERVED, PURCHASED };
-
-    State state;
-    float x, y;
-
-    const bool isAt(double mx, double my) {
-        constexpr double half = 0.08f;
-
-        return mx > (x - half) && mx < (x + half) &&
-            my >(y - half) && my < (y + half);
-    }
-};
-
-Seat seats[ROWS][COLS];
+HallLayout hallLayout;
+Hall hall;
+BookingEngine booking;
+Journal journal;
+ReservationHolds holds(HOLD_DURATION_SECONDS);
+Redraw redraw;
+Crowd crowd;
+CrowdClock crowdClock;
+std::vector<int> attendees;
+std::vector<float> attendeeX, attendeeY;
+std::mt19937 rng(std::random_device{}());
 
 struct Door {
     float x, y;
@@ -49,41 +71,70 @@ Door door = { -.99f, .2f, 0.2f, 0.05f, false, 0.2f };
 float doorMaxWidth = 0.6f, doorSpeed = 0.01f;
 
 void initSeats() {
-    float seatScale = 0.04f;
-    float seatSize = seatScale * 2.0f;
-    float spacing = seatSize * 2.2f;
-
-    float totalWidth = COLS * spacing;
-    float startX = -totalWidth / 2.0f + spacing / 2.0f;
-
-    float centerY = -0.4f;
-    float totalHeight = ROWS * spacing;
-    float startY = centerY + totalHeight / 2.0f - spacing / 2.0f;
-
-    for (int r = 0; r < ROWS; r++) {
-        for (int c = 0; c < COLS; c++) {
-            seats[r][c].x = startX + c * spacing;
-            seats[r][c].y = startY - r * spacing;
-            seats[r][c].state = Seat::FREE;
-        }
-    }
+    hall = buildHall(hallLayout);
+
+    // bookings from before a crash or restart, one journal per layout; the engine starts
+    // logging only after it has them
+    journal.open("cinema-" + hallLayoutKey(hallLayout), hall);
+    booking.reset(hall);
+    booking.attach(&journal);
+
+    holds.reset(hall.size(), glfwGetTime());
+    for (int i = 0; i < hall.size(); ++i)
+        if (hall.states[i] == Seat::RESERVED) holds.hold(i, glfwGetTime(), booking.generation(i));
+
+    redraw.mark(Redraw::SEATS | Redraw::TEXT);
 }
 
+// After every screening; the layout stays, only the states are cleared
+void resetSeats() {
+    resetHall(hall);
+    booking.reset(hall);
+    holds.reset(hall.size(), glfwGetTime());
+    redraw.mark(Redraw::SEATS | Redraw::TEXT);
+}
+
+// Brings the hall up to date with the engine; only a real change costs a redraw
+void syncHall() {
+    if (booking.sync(hall, &redraw.seats)) redraw.mark(Redraw::TEXT);
+}
 
+// Rightmost n adjacent free seats, starting from the last row
 void purchaseFirstNFreeSeats(int n) {
-    for (int r = ROWS - 1; r >= 0 && n > 0; --r) {
-        for (int c = COLS - 1; c >= 0 && n > 0; --c) {
-            if (seats[r][c].state == Seat::FREE) {
-                seats[r][c].state = Seat::PURCHASED;
-                --n;
-            }
-        }
-    }
+    // The hall's index picks the run; the engine validates it against concurrent bookings
+    booking.purchaseAdjacent(n, [](int n) {
+        syncHall();
+        return hall.findFreeRun(n);
+    });
+    syncHall();
 }
 
+// Costs O(people): the hall keeps its occupied seats listed, the attendees are sampled from
+// that list and the buffers are reused between screenings
 void startProjection() {
-    projectionEndTime = glfwGetTime() + PROJECTION_DURATION_SECONDS;
+    // no screening for an empty hall
+    if (hall.occupied.size() == 0) return;
+
+    // not everyone with a ticket shows up
+    std::uniform_int_distribution<int> dist(1, hall.occupied.size());
+    int peopleCount = dist(rng);
+    hall.occupied.sample(peopleCount, rng, attendees);
+
+    attendeeX.resize(peopleCount);
+    attendeeY.resize(peopleCount);
+    for (int i = 0; i < peopleCount; i++) {
+        attendeeX[i] = hall.geometry->xs[attendees[i]];
+        attendeeY[i] = hall.geometry->ys[attendees[i]];
+    }
+    // one after another through the door, everyone inside within a few seconds
+    float interval = std::min(PERSON_ENTRY_INTERVAL, 5.0f / peopleCount);
+    crowd.spawn(attendeeX.data(), attendeeY.data(), peopleCount, door.x, door.y,
+        PERSON_SPEED, crowdClock.now(glfwGetTime()), interval);
+
+    // the seats stay as they are; the overlay lifts and the people appear at the door
+    screening = Screening::ENTERING;
     door.open = true;
+    redraw.mark(Redraw::OVERLAY | Redraw::PEOPLE);
 }
 
 void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
@@ -91,7 +142,7 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
     case GLFW_MOUSE_BUTTON_LEFT:
         glfwSetCursor(window, action == GLFW_PRESS ? cursorPressed : cursor);
 
-        if (action == GLFW_PRESS && projectionEndTime == -1) {
+        if (action == GLFW_PRESS && screening == Screening::IDLE) {
             double mx, my;
             glfwGetCursorPos(window, &mx, &my);
 
@@ -99,20 +150,14 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
             mx = (mx / width) * 2.0f - 1.0f;
             my = 1.0 - (my / height) * 2.0;
 
-            for (int r = 0; r < ROWS; r++) {
-                for (int c = 0; c < COLS; c++) {
-                    Seat &s = seats[r][c];
-
-                    if (s.isAt(mx, my)) {
-                        if (s.state == Seat::State::FREE)
-                            s.state = Seat::State::RESERVED;
-                        else if (s.state == Seat::State::RESERVED)
-                            s.state = Seat::State::FREE;
+            int i = hall.seatAt(mx, my);
+            if (i != -1 && booking.toggle(i)) {
+                if (booking.state(i) == Seat::RESERVED)
+                    holds.hold(i, glfwGetTime(), booking.generation(i));
+                else
+                    holds.release(i);
 
-                        r = ROWS;
-                        break;
-                    }
-                }
+                syncHall();
             }
         }
         break;
@@ -125,12 +170,27 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
         glfwSetWindowShouldClose(window, action == GLFW_PRESS ? GLFW_TRUE : GLFW_FALSE);
         break;
     case GLFW_KEY_ENTER:
-        if (action == GLFW_PRESS && projectionEndTime == -1) {
+        if (action == GLFW_PRESS && screening == Screening::IDLE) {
             startProjection();
         }
         break;
+    case GLFW_KEY_P:
+        // pause or resume the people
+        if (action == GLFW_PRESS) {
+            if (crowdClock.paused) crowdClock.resume(glfwGetTime());
+            else crowdClock.pause(glfwGetTime());
+        }
+        break;
+    case GLFW_KEY_LEFT:
+    case GLFW_KEY_RIGHT:
+        // seek the people back or forward; positions are recomputed for the new time, not stepped
+        if (action != GLFW_RELEASE) {
+            crowdClock.seek(glfwGetTime(), key == GLFW_KEY_RIGHT ? CROWD_SEEK_SECONDS : -CROWD_SEEK_SECONDS);
+            redraw.mark(Redraw::PEOPLE);
+        }
+        break;
     default:
-        if (action == GLFW_PRESS && key >= GLFW_KEY_0 && key <= GLFW_KEY_9 && projectionEndTime == -1) {
+        if (action == GLFW_PRESS && key >= GLFW_KEY_0 && key <= GLFW_KEY_9 && screening == Screening::IDLE) {
             int n = key - GLFW_KEY_0;
             purchaseFirstNFreeSeats(n);
         }
@@ -138,10 +198,13 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
     }
 }
 
+void windowRefreshCallback(GLFWwindow* window) {
+    redraw.mark(Redraw::ALL);
+}
+
 void formVAOs(
     float *verticesCanvas, size_t canvasSize, unsigned int &VAOcanvas,
     float* verticesOverlay, size_t overlaySize, unsigned int& VAOoverlay,
-    float* verticesSeat, size_t seatSize, unsigned int& VAOseat,
     float* verticesDoor, size_t doorSize, unsigned int& VAOdoor,
     float* verticesTextBg, size_t textBgSize, unsigned int& VAOtextBg
 ) {
@@ -150,8 +213,8 @@ void formVAOs(
     glGenVertexArrays(1, &VAOcanvas);
     glGenBuffers(1, &VBOcanvas);
 
-    glBindVertexArray(VAOcanvas);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOcanvas);
+    glState().bindVertexArray(VAOcanvas);
+    glState().bindArrayBuffer(VBOcanvas);
     glBufferData(GL_ARRAY_BUFFER, canvasSize, verticesCanvas, GL_STATIC_DRAW);
 
     // Position
@@ -163,44 +226,58 @@ void formVAOs(
     glGenVertexArrays(1, &VAOoverlay);
     glGenBuffers(1, &VBOoverlay);
 
-    glBindVertexArray(VAOoverlay);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOoverlay);
+    glState().bindVertexArray(VAOoverlay);
+    glState().bindArrayBuffer(VBOoverlay);
     glBufferData(GL_ARRAY_BUFFER, overlaySize, verticesOverlay, GL_STATIC_DRAW);
 
     // Position
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    // Seat
-    unsigned VBOseat;
-    glGenVertexArrays(1, &VAOseat);
-    glGenBuffers(1, &VBOseat);
-
-    glBindVertexArray(VAOseat);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOseat);
-    glBufferData(GL_ARRAY_BUFFER, seatSize, verticesSeat, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
     unsigned VBOdoor;
     glGenVertexArrays(1, &VAOdoor);
     glGenBuffers(1, &VBOdoor);
 
-    glBindVertexArray(VAOdoor);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOdoor);
+    glState().bindVertexArray(VAOdoor);
+    glState().bindArrayBuffer(VBOdoor);
     glBufferData(GL_ARRAY_BUFFER, doorSize, verticesDoor, GL_STATIC_DRAW);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
+
+    // Text background
+    unsigned VBOtextBg;
+    glGenVertexArrays(1, &VAOtextBg);
+    glGenBuffers(1, &VBOtextBg);
+
+    glState().bindVertexArray(VAOtextBg);
+    glState().bindArrayBuffer(VBOtextBg);
+    glBufferData(GL_ARRAY_BUFFER, textBgSize, verticesTextBg, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
 }
 
-int main()
+int main(int argc, char **argv)
 {
+    if (argc >= 2 && std::string(argv[1]) == "--bench-journal")
+        return runJournalBenchmark("bench", 1000000);
+    if (argc >= 2 && std::string(argv[1]) == "--stress-booking")
+        return runBookingStressTest(argc >= 3 ? std::atoi(argv[2]) : 8, 200);
+    if (argc >= 2 && std::string(argv[1]) == "--bench-crowd")
+        return runCrowdBenchmark(argc >= 3 ? std::atoi(argv[2]) : 100000, argc >= 4 ? static_cast<float>(std::atof(argv[3])) : 0.0f);
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+    PacingOptions pacing = parsePacingOptions(takeOption(argc, argv, "--pacing"), takeOption(argc, argv, "--fps"),
+        takeOption(argc, argv, "--render"));
+    // Cinema.exe [--seat basic|rounded|sdf|...]
+    const std::string seatMeshName = takeOption(argc, argv, "--seat", "basic");
+    // Cinema.exe [--crowd free|queue]
+    if (takeOption(argc, argv, "--crowd", "free") == "queue") crowd.setQueueing(PERSON_GAP);
+    FramePacer pacer(pacing);
+    hallLayout = parseHallLayout(argc, argv);
     initSeats();
 
     auto *monitor = glfwGetPrimaryMonitor();
@@ -224,15 +301,22 @@ int main()
 
     glfwSetMouseButtonCallback(window, mouseButtonCallback);
     glfwSetKeyCallback(window, keyCallback);
+    glfwSetWindowRefreshCallback(window, windowRefreshCallback);
 
     if (glewInit() != GLEW_OK) return endProgram("GLEW nije uspeo da se inicijalizuje.");
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glState().blend(true);
+    glState().blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    ShaderProgram
+        rectShader = ShaderProgram::load("res/rect.vert", "res/rect.frag"),
+        textShader = ShaderProgram::load("res/text.vert", "res/text.frag"),
+        layerShader = ShaderProgram::load("res/layer.vert", "res/layer.frag");
 
-    unsigned
-        rectShader = createShader("res/rect.vert", "res/rect.frag"),
-        textShader = createShader("res/text.vert", "res/text.frag");
+    // signed-distance seats are one quad each, shaped per pixel; meshes use the plain shader
+    const ShaderProgram seatShader = seatMeshName == "sdf"
+        ? ShaderProgram::load("res/seat_sdf.vert", "res/seat_sdf.frag")
+        : rectShader;
 
     //region vertices
 
@@ -250,32 +334,6 @@ int main()
         1.0f, 1.0f
     };
 
-    float verticesSeat[] = {
-        // Backrest
-        -0.55f, 0.5f,
-        -0.55f, 0.1f,
-        0.55f, 0.1f,
-        0.55f, 0.5f,
-
-        // Cushion
-        -0.6f,-0.1f,
-        -0.6f,-0.5f,
-        0.6f,-0.5f,
-        0.6f,-0.1f,
-
-        // Left armrest
-        -0.75f, 0.3f,
-        -0.75f,-0.3f,
-        -0.6f, -0.3f,
-        -0.6f,  0.3f,
-
-        // Right armrest
-        0.75f, 0.3f,
-        0.75f,-0.3f,
-        0.6f, -0.3f,
-        0.6f,  0.3f
-    };
-
     float verticesDoor[] = {
         -0.5f,  0.5f,
         -0.5f, -0.5f,
@@ -287,39 +345,127 @@ int main()
 
     //region VAOs
 
-    unsigned VAOcanvas, VAOoverlay, VAOseat, VAOdoor, VAOtextBg;
+    unsigned VAOcanvas, VAOoverlay, VAOdoor, VAOtextBg;
 
     formVAOs(
         verticesCanvas, sizeof(verticesCanvas), VAOcanvas,
         verticesOverlay, sizeof(verticesOverlay), VAOoverlay,
-        verticesSeat, sizeof(verticesSeat), VAOseat,
         verticesDoor, sizeof(verticesDoor), VAOdoor,
         verticesCanvas, sizeof(verticesCanvas), VAOtextBg
     );
 
-    unsigned VAOtext, VBOtext;
-    glGenVertexArrays(1, &VAOtext);
-    glGenBuffers(1, &VBOtext);
-    glBindVertexArray(VAOtext);
-    glBindBuffer(GL_ARRAY_BUFFER, VBOtext);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 100000, NULL, GL_DYNAMIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glBindVertexArray(0);
+    TextCache textCache;
+
+    StaticLayer staticLayer;
+    staticLayer.init(width, height);
+
+    // what goes into the cached layer, and what is drawn over it every frame
+    CommandBuffer layerCommands, screenCommands;
+
+    // per-frame vertices: live counters and people (8 bytes each, 100k fit in a frame)
+    StreamBuffer stream;
+    stream.init(1024 * 1024);
+
+    ShaderProgram personShader = ShaderProgram::load("res/person.vert", "res/person.frag");
+    CrowdRenderer crowdRenderer;
+    crowdRenderer.init(makePersonMesh(), stream);
+
+    // per-frame crowd work is split over the workers; GL calls stay on this thread.
+    // Seat queries and HUD text are not: the counters are O(1) and the text is one cached string.
+    JobSystem jobs;
+
+    SeatRenderer seatRenderer;
+    const SeatMesh seatMesh = makeSeatMesh(seatMeshName);
+    seatRenderer.init(seatMesh);
+    seatRenderer.setPositions(hall.geometry->xs.data(), hall.geometry->ys.data(), hall.size());
 
     //endregion
 
+    const float seatPalette[][4] = {
+        { 0, 0, 1, 1 },   // FREE: blue
+        { 1, 1, 0, 1 },   // RESERVED: yellow
+        { 1, 0, 0, 1 }    // PURCHASED: red
+    };
+    setSeatPalette(seatShader, seatPalette, 3);
+
     glClearColor(0.2f, 0.8f, 0.6f, 1.0f);
 
+    //region draw recording
+
+    auto recordHall = [&](CommandBuffer &commands) {
+        commands.record(LAYER_CANVAS, rectShader, VAOcanvas, true, [&, r = cR, g = cG, b = cB] {
+            rectShader.setVec4("uColor", r, g, b, 1);
+            rectShader.setVec2("uScale", 0.6f, 0.4f);
+            rectShader.setVec2("uOffset", 0.0f, 0.5f);
+            glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+        });
+
+        commands.record(LAYER_SEATS, seatShader, seatRenderer.VAO, true, [&] {
+            seatRenderer.draw(seatShader, hall.geometry->seatSize);
+        });
+    };
+
+    auto recordDoor = [&](CommandBuffer &commands) {
+        const float scaleX = (door.currentWidth / doorMaxWidth) * .05f;
+        commands.record(LAYER_DOOR, rectShader, VAOdoor, true, [&, scaleX] {
+            rectShader.setVec4("uColor", 0.5f, 0.25f, 0.0f, 1.0f); // brown
+            rectShader.setVec2("uScale", scaleX, .15f);
+            rectShader.setVec2("uOffset", door.x, door.y);
+            glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+        });
+    };
+
+    std::string hudCounts;
+    auto recordHud = [&](CommandBuffer &commands) {
+        commands.record(LAYER_HUD_BACKGROUND, rectShader, VAOtextBg, true, [&] {
+            rectShader.setVec4("uColor", 0.1f, 0.1f, 0.1f, 0.6f);
+            rectShader.setVec2("uScale", .3f, .08f);
+            rectShader.setVec2("uOffset", .8f, -.89f);
+            glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+        });
+
+        float textScale = 3.0f;
+        float textX = width * 0.77f;
+        float textY = height * 0.93f;
+        float scaleX = textScale * 2.0f / width;
+        float scaleY = textScale * 2.0f / height;
+
+        const TextMesh *author = &textCache.mesh("SV77/2022 Aleksa Cetkovic", TextStyle());
+        commands.record(LAYER_HUD_TEXT, textShader, author->VAO, true, [&, author, scaleX, scaleY, textX, textY] {
+            TextCache::drawMesh(*author, TextStyle(), textShader,
+                textX * 2.0f / width - 1.0f, 1.0f - textY * 2.0f / height, scaleX, scaleY);
+        });
+
+        // seat counters change with every booking, so they are streamed rather than given a mesh;
+        // the string is only rebuilt when a booking marked the text, and its layout is cached
+        if (redraw.has(Redraw::TEXT)) {
+            hudCounts = "Slobodno: " + std::to_string(hall.countFree())
+                + "  Rezervisano: " + std::to_string(hall.countReserved())
+                + "  Kupljeno: " + std::to_string(hall.countPurchased());
+        }
+        TransientText counters = textCache.stream(stream, hudCounts, TextStyle());
+        commands.record(LAYER_HUD_TEXT, textShader, counters.VAO, true, [&, counters, scaleX, scaleY] {
+            TextCache::drawTransient(counters, TextStyle(), textShader, -0.98f, 0.98f, scaleX, scaleY);
+        });
+    };
+
+    //endregion
+
+    pacer.begin();
+
     for (int frameCnt = 0; !glfwWindowShouldClose(window); ++frameCnt)
     {
         const double initFrameTime = glfwGetTime();
-        const bool isProjecting = initFrameTime < projectionEndTime;
+        const bool filmRunning = screening == Screening::FILM;
 
-        glClear(GL_COLOR_BUFFER_BIT);
+        // release abandoned reservations, then pick up bookings made by other terminals
+        if (screening == Screening::IDLE)
+            holds.expire(initFrameTime, booking);
+        syncHall();
 
-        // draw canvas
-        if (!isProjecting /* && people entered */) {
+        // canvas flickers during the film, white otherwise
+        const float oldR = cR, oldG = cG, oldB = cB;
+        if (!filmRunning) {
             cR = cG = cB = 1;
         }
         else if (cR == 1 && cG == 1 && cB == 1 || (frameCnt %= CANVAS_COLOUR_DURATION_FRAMES) == 0) {
@@ -327,165 +473,152 @@ int main()
             cG = static_cast<float>(rand()) / RAND_MAX;
             cB = static_cast<float>(rand()) / RAND_MAX;
         }
-
-        glUseProgram(rectShader);
-
-        glUniform4f(glGetUniformLocation(rectShader, "uColor"), cR, cG, cB, 1);
-        glUniform2f(glGetUniformLocation(rectShader, "uScale"), 0.6f, 0.4f);
-        glUniform2f(glGetUniformLocation(rectShader, "uOffset"), 0.0f, 0.5f);
-
-        glBindVertexArray(VAOcanvas);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-
-        // draw seats
-        for (int r = 0; r < ROWS; ++r) {
-            for (int c = 0; c < COLS; ++c) {
-                auto &seat = seats[r][c];
-                float sr, sg, sb;
-
-                switch (seat.state) {
-                case Seat::PURCHASED:  // red
-                    sr = 1; sg = 0; sb = 0;
-                    break;
-
-                case Seat::RESERVED:   // yellow
-                    sr = 1; sg = 1; sb = 0;
-                    break;
-
-                case Seat::FREE:       // blue
-                default:
-                    sr = 0; sg = 0; sb = 1;
-                    break;
-                }
-
-                glUseProgram(rectShader);
-                glUniform4f(glGetUniformLocation(rectShader, "uColor"), sr, sg, sb, 1);
-                glUniform2f(glGetUniformLocation(rectShader, "uScale"), 0.08f, 0.08f);
-                glUniform2f(glGetUniformLocation(rectShader, "uOffset"), seat.x, seat.y);
-
-                glBindVertexArray(VAOseat);
-                glDrawArrays(GL_TRIANGLE_FAN, 0, 4);   // backrest
-                glDrawArrays(GL_TRIANGLE_FAN, 4, 4);   // cushion
-                glDrawArrays(GL_TRIANGLE_FAN, 8, 4);   // left armrest
-                glDrawArrays(GL_TRIANGLE_FAN, 12, 4);  // right armrest
-            }
-        }
+        if (cR != oldR || cG != oldG || cB != oldB) redraw.mark(Redraw::CANVAS);
 
         // door opening/closing logic
+        bool doorMoving = true;
         if (door.open && door.currentWidth < doorMaxWidth) {
             door.currentWidth += doorSpeed;
             if (door.currentWidth > doorMaxWidth) door.currentWidth = doorMaxWidth;
         }
-        if (!door.open && door.currentWidth > door.width) {
+        else if (!door.open && door.currentWidth > door.width) {
             door.currentWidth -= doorSpeed;
             if (door.currentWidth < door.width) door.currentWidth = door.width;
         }
+        else {
+            doorMoving = false;
+        }
+        if (doorMoving) redraw.mark(Redraw::DOOR);
+
+        // people walk in at the start of a screening and out at its end
+        if (crowd.size() > 0 && (crowd.walking() > 0 || redraw.has(Redraw::PEOPLE)))
+            crowd.evaluate(crowdClock.now(initFrameTime), jobs);
+        const bool peopleMoving = crowd.walking() > 0 && !crowdClock.paused;
+        if (peopleMoving) redraw.mark(Redraw::PEOPLE);
+
+        if (!pacing.redrawOnChange || redraw.any()) {
+            // repaint what changed in the cached layer, then show it with one quad
+            LayerRect area;
+            if (redraw.has(Redraw::CANVAS | Redraw::SEATS)) {
+                area.add(0, 0, 1, 1);
+            }
+            else {
+                const HallGeometry &geometry = *hall.geometry;
+                for (int i : redraw.seats)
+                    area.add(geometry.xs[i], geometry.ys[i], geometry.seatSize * seatMesh.halfWidth, geometry.seatSize * seatMesh.halfHeight);
+                if (redraw.has(Redraw::DOOR))
+                    area.add(door.x, door.y, .025f, .075f);
+            }
 
-        // draw door
-        glUseProgram(rectShader);
-        glUniform4f(glGetUniformLocation(rectShader, "uColor"), 0.5f, 0.25f, 0.0f, 1.0f); // brown
-        glUniform2f(glGetUniformLocation(rectShader, "uScale"), (door.currentWidth / doorMaxWidth) * .05f, .15f);
-        glUniform2f(glGetUniformLocation(rectShader, "uOffset"), door.x, door.y);
-
-        glBindVertexArray(VAOdoor);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+            if (redraw.has(Redraw::SEATS))
+                seatRenderer.uploadStates(hall.states.data(), hall.size());
+            else
+                seatRenderer.updateStates(hall.states.data(), redraw.seats);
 
+            if (!area.empty()) {
+                recordHall(layerCommands);
+                recordDoor(layerCommands);
 
+                staticLayer.begin(area);
+                layerCommands.submit();
+                staticLayer.end();
+            }
 
-        // draw overlay
-        if (!isProjecting) {
-            glUseProgram(rectShader);
-            glUniform4f(glGetUniformLocation(rectShader, "uColor"), .1f, .1f, .1f, .5f);
-            glUniform2f(glGetUniformLocation(rectShader, "uScale"), 1.0f, 1.0f);
-            glUniform2f(glGetUniformLocation(rectShader, "uOffset"), .0f, .0f);
+            // overlay is folded into the composite; it is gone from Enter until the last one is out
+            const float dim[4] = { .1f, .1f, .1f, screening == Screening::IDLE ? .5f : 0.0f };
+            screenCommands.record(LAYER_COMPOSITE, layerShader, VAOoverlay, false, [&, dim] {
+                staticLayer.composite(layerShader, VAOoverlay, dim);
+            });
+            stream.beginFrame();
+            const float personColor[4] = {
+                .95f + (dim[0] - .95f) * dim[3], .55f + (dim[1] - .55f) * dim[3], .15f + (dim[2] - .15f) * dim[3], 1.0f
+            };
+            crowdRenderer.upload(crowd, stream, jobs);
+            screenCommands.record(LAYER_CROWD, personShader, crowdRenderer.VAO, true, [&, personColor] {
+                crowdRenderer.draw(personShader, PERSON_SIZE, personColor);
+            });
+
+            recordHud(screenCommands);
+            stream.flush();
+            screenCommands.submit();
+            stream.endFrame();
+
+            textCache.endFrame();
+
+            glfwSwapBuffers(window);
+            glState().endFrame();
+            redraw.clear();
+        }
 
-            glBindVertexArray(VAOoverlay);
-            glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+        // keep the frame rate while something animates, otherwise sleep until input or the next check
+        // (expiring holds, bookings from other terminals)
+        if (!pacing.redrawOnChange || filmRunning || doorMoving || peopleMoving) {
+            glfwPollEvents();
+            pacer.wait();
         }
+        else {
+            glfwWaitEventsTimeout(IDLE_WAKE_SECONDS);
+            pacer.resume();
+        }
+
+        const double now = glfwGetTime();
 
-        // draw text background
-        glUseProgram(rectShader);
-        glUniform4f(glGetUniformLocation(rectShader, "uColor"), 0.1f, 0.1f, 0.1f, 0.6f);
-        glUniform2f(glGetUniformLocation(rectShader, "uScale"), .3f, .08f);
-        glUniform2f(glGetUniformLocation(rectShader, "uOffset"), .8f, -.89f);
-
-        glBindVertexArray(VAOtextBg);
-        glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-
-        // draw text 
-        static float buffer[99999];
-        static float vertex_buffer[99999];
-        int num_quads;
-
-        num_quads = stb_easy_font_print(0, 0, (char*)"SV77/2022 Aleksa Cetkovic", NULL, buffer, sizeof(buffer));
-
-        // Convert quads to triangles and flip Y coordinate
-        int vertex_count = 0;
-        for (int i = 0; i < num_quads; i++) {
-            float* quad = buffer + i * 16; // 4 vertices * 4 floats (x,y,z,w)
-
-            // First triangle (0, 1, 2)
-            vertex_buffer[vertex_count++] = quad[0];  // x
-            vertex_buffer[vertex_count++] = -quad[1]; // -y (flip vertically)
-            vertex_buffer[vertex_count++] = quad[2];  // z
-            vertex_buffer[vertex_count++] = quad[3];  // w
-
-            vertex_buffer[vertex_count++] = quad[4];  // x
-            vertex_buffer[vertex_count++] = -quad[5]; // -y
-            vertex_buffer[vertex_count++] = quad[6];  // z
-            vertex_buffer[vertex_count++] = quad[7];  // w
-
-            vertex_buffer[vertex_count++] = quad[8];  // x
-            vertex_buffer[vertex_count++] = -quad[9]; // -y
-            vertex_buffer[vertex_count++] = quad[10]; // z
-            vertex_buffer[vertex_count++] = quad[11]; // w
-
-            // Second triangle (0, 2, 3)
-            vertex_buffer[vertex_count++] = quad[0];  // x
-            vertex_buffer[vertex_count++] = -quad[1]; // -y
-            vertex_buffer[vertex_count++] = quad[2];  // z
-            vertex_buffer[vertex_count++] = quad[3];  // w
-
-            vertex_buffer[vertex_count++] = quad[8];  // x
-            vertex_buffer[vertex_count++] = -quad[9]; // -y
-            vertex_buffer[vertex_count++] = quad[10]; // z
-            vertex_buffer[vertex_count++] = quad[11]; // w
-
-            vertex_buffer[vertex_count++] = quad[12]; // x
-            vertex_buffer[vertex_count++] = -quad[13]; // -y
-            vertex_buffer[vertex_count++] = quad[14]; // z
-            vertex_buffer[vertex_count++] = quad[15]; // w
+        // everyone seated: the door closes and the film starts
+        if (screening == Screening::ENTERING && crowd.allSeated()) {
+            screening = Screening::FILM;
+            filmEndTime = now + PROJECTION_DURATION_SECONDS;
+            door.open = false;
         }
 
-        glUseProgram(textShader);
+        // film over: the door opens and everyone heads out
+        if (screening == Screening::FILM && now >= filmEndTime) {
+            screening = Screening::EXITING;
+            crowd.beginExit(crowdClock.now(now));
+
+            // a queueing crowd leaves through the door one gap at a time, so a big hall
+            // takes minutes; the fallback only ends a walk-out that has clearly stalled
+            double exitSeconds = PROJECTION_DURATION_SECONDS;
+            if (crowd.queueing()) exitSeconds += 2.0 * crowd.size() * PERSON_GAP / PERSON_SPEED;
+            exitDeadline = crowdClock.now(now) + exitSeconds;
+            door.open = true;
+            redraw.mark(Redraw::PEOPLE);
+        }
 
-        float textScale = 3.0f;
-        float textX = width * 0.77f;
-        float textY = height * 0.93f;
-        float scaleX = textScale * 2.0f / width;
-        float scaleY = textScale * 2.0f / height;
+        // the hall resets once the last one is through the door
+        if (screening == Screening::EXITING && (crowd.allLeft() || crowdClock.now(now) > exitDeadline)) {
+            screening = Screening::IDLE;
+            door.open = false;
+            resetSeats();
+            crowd.clear();
+            redraw.mark(Redraw::OVERLAY | Redraw::PEOPLE);
+        }
+    }
 
-        glUniform2f(glGetUniformLocation(textShader, "uOffset"), textX * 2.0f / width - 1.0f, 1.0f - textY * 2.0f / height);
-        glUniform2f(glGetUniformLocation(textShader, "uScale"), scaleX, scaleY);
-        glUniform4f(glGetUniformLocation(textShader, "uColor"), 1.0f, 1.0f, 1.0f, 1.0f);
+    pacer.end();
+    journal.close();
 
-        glBindVertexArray(VAOtext);
-        glBindBuffer(GL_ARRAY_BUFFER, VBOtext);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, vertex_count * sizeof(float), vertex_buffer);
+    PacingStats paced = pacer.stats();
+    std::cout << "Kadrovi: " << paced.frames << ", propusteni rokovi: " << paced.missed
+        << ", prosek " << paced.meanMs << " ms, odstupanje " << paced.jitterMs << " ms, najduzi " << paced.worstMs
+        << " ms, vrtenje " << paced.spinFraction * 100.0 << "% vremena" << std::endl;
 
-        glDrawArrays(GL_TRIANGLES, 0, num_quads * 6);
+    const StreamStats &streamed = stream.stats();
+    std::cout << "Strim bafer: " << (stream.persistent() ? "trajno mapiran" : "mapiran po kadru") << ", cekanja " << streamed.waits
+        << ", zamena " << streamed.orphans << ", prelivanja " << streamed.overflows << std::endl;
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    const GLStateCounts &gl = glState().total();
+    const double drawn = static_cast<double>(glState().frames());
+    if (drawn > 0)
+        std::cout << "GL po kadru: " << gl.issued / drawn << " poziva, preskoceno "
+            << gl.skippedPrograms / drawn << " programa, " << gl.skippedVertexArrays / drawn << " VAO, "
+            << gl.skippedBuffers / drawn << " bafera, " << gl.skippedBlend / drawn << " blend" << std::endl;
 
-        while (glfwGetTime() - initFrameTime < MIN_FRAME_DURATION_SECONDS) {}
+    JobStats jobStats = jobs.stats();
+    std::cout << "Niti: " << jobs.threadCount() << ", poslova " << jobStats.jobs << " u " << jobStats.batches
+        << " paketa, ukradeno " << jobStats.steals << std::endl;
 
-        if (isProjecting && glfwGetTime() >= projectionEndTime || projectionEndTime != -1 && (glfwGetTime() - projectionEndTime) > PROJECTION_DURATION_SECONDS) {
-            projectionEndTime = -1;
-            door.open = false; /* wait for people to go out */
-            initSeats();
-        }
-    }
+    TxnStats txn = booking.txnStats();
+    std::cout << "Grupne kupovine: " << txn.commits << " uspesnih, " << txn.aborts << " ponistenih, " << txn.retries << " ponovljenih" << std::endl;
 
     glfwDestroyWindow(window);
     glfwTerminate();
@@ -0,0 +1,51 @@
+#include "OccupiedSeats.h"
+
+#include <algorithm>
+
+#include "Hall.h"
+
+void OccupiedSeats::build(int count, const unsigned char *states) {
+    list.clear();
+    place.assign(count, -1);
+    reservedCount = 0;
+
+    for (int i = 0; i < count; i++)
+        set(i, Seat::FREE, states[i]);
+}
+
+void OccupiedSeats::set(int seat, unsigned char from, unsigned char to) {
+    reservedCount += (to == Seat::RESERVED) - (from == Seat::RESERVED);
+
+    if (from == Seat::FREE && to != Seat::FREE) {
+        place[seat] = static_cast<int>(list.size());
+        list.push_back(seat);
+    }
+    else if (from != Seat::FREE && to == Seat::FREE) {
+        int p = place[seat];
+        list[p] = list.back();
+        place[list[p]] = p;
+        list.pop_back();
+        place[seat] = -1;
+    }
+}
+
+void OccupiedSeats::reset() {
+    for (int seat : list) place[seat] = -1;
+    list.clear();
+    reservedCount = 0;
+}
+
+void OccupiedSeats::swapPlaces(int a, int b) {
+    std::swap(list[a], list[b]);
+    place[list[a]] = a;
+    place[list[b]] = b;
+}
+
+void OccupiedSeats::sample(int k, std::mt19937 &rng, std::vector<int> &out) {
+    k = std::min(k, size());
+    for (int i = 0; i < k; i++) {
+        std::uniform_int_distribution<int> pick(i, size() - 1);
+        swapPlaces(i, pick(rng));
+    }
+    out.assign(list.begin(), list.begin() + k);
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <random>
+#include <vector>
+
+// Every reserved or purchased seat in one unordered list, with each seat's place in it, so a
+// seat joins or leaves in O(1) (the last one moves into its place). Counts per state are kept
+// alongside, so nothing has to scan the hall to know how full it is.
+class OccupiedSeats {
+public:
+    void build(int count, const unsigned char *states);
+    void set(int seat, unsigned char from, unsigned char to);
+
+    // Back to an all-free hall; touches only the seats that were occupied
+    void reset();
+
+    int size() const { return static_cast<int>(list.size()); }
+    int reserved() const { return reservedCount; }
+    int purchased() const { return size() - reservedCount; }
+    const std::vector<int> &seats() const { return list; }
+
+    // k different occupied seats, every choice equally likely: a partial Fisher-Yates shuffle
+    // of the first k places of the list, so O(k). The list comes out in a different order.
+    void sample(int k, std::mt19937 &rng, std::vector<int> &out);
+
+private:
+    std::vector<int> list;
+    std::vector<int> place;     // per seat, index in list or -1 when free
+    int reservedCount = 0;
+
+    void swapPlaces(int a, int b);
+};
@@ -0,0 +1,18 @@
+#include "Options.h"
+
+#include <cstring>
+
+std::string takeOption(int &argc, char **argv, const char *name, const std::string &fallback) {
+    std::string value = fallback;
+
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], name) == 0 && i + 1 < argc)
+            value = argv[++i];
+        else
+            argv[kept++] = argv[i];
+    }
+
+    argc = kept;
+    return value;
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include <string>
+
+// Cinema.exe [--name value] ...: removes every "--name value" pair from argv, so the positional
+// arguments are left for parseHallLayout, and returns the last value, or `fallback` without one
+std::string takeOption(int &argc, char **argv, const char *name, const std::string &fallback = "");
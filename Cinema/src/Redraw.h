@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+
+// What changed since the last drawn frame. In on-change mode a frame is drawn only
+// when something is dirty; the whole frame is redrawn since the back buffer is not kept.
+struct Redraw {
+    enum Layer : unsigned {
+        CANVAS = 1 << 0,
+        SEATS = 1 << 1,
+        DOOR = 1 << 2,
+        PEOPLE = 1 << 3,
+        OVERLAY = 1 << 4,
+        TEXT = 1 << 5,
+        ALL = ~0u
+    };
+
+    unsigned dirty = ALL;
+
+    // Seats whose state changed, appended by BookingEngine::sync; SEATS means all of them
+    std::vector<int> seats;
+
+    void mark(unsigned layers) { dirty |= layers; }
+    bool any() const { return dirty != 0 || !seats.empty(); }
+    bool has(unsigned layers) const { return (dirty & layers) != 0; }
+    void clear() { dirty = 0; seats.clear(); }
+};
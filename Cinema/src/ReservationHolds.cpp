@@ -0,0 +1,32 @@
+#include "ReservationHolds.h"
+
+constexpr uint32_t ReservationHolds::NO_HOLD;
+
+void ReservationHolds::reset(int seats, double now) {
+    wheel.reset(now);
+    holdGenerations.assign(seats, NO_HOLD);
+}
+
+void ReservationHolds::hold(int seat, double now, uint32_t generation) {
+    holdGenerations[seat] = generation;
+    wheel.schedule(static_cast<uint64_t>(generation) << 32 | static_cast<uint32_t>(seat), now + ttl);
+}
+
+void ReservationHolds::release(int seat) {
+    holdGenerations[seat] = NO_HOLD;
+}
+
+int ReservationHolds::expire(double now, BookingEngine &booking) {
+    int freed = 0;
+
+    wheel.advance(now, [&](uint64_t id, uint64_t) {
+        int seat = static_cast<int>(id & 0xffffffffu);
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+        if (holdGenerations[seat] != generation) return;
+
+        holdGenerations[seat] = NO_HOLD;
+        if (booking.expireHold(seat, generation)) freed++;
+    });
+
+    return freed;
+}
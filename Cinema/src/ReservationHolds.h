@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "BookingEngine.h"
+#include "TimerWheel.h"
+
+// Reservations expire: every hold gets a timer on the wheel and is released back to
+// FREE when it runs out. Main thread only; `now` is glfwGetTime() or a simulated clock.
+class ReservationHolds {
+public:
+    explicit ReservationHolds(double ttlSeconds) : ttl(ttlSeconds) {}
+
+    void reset(int seats, double now);
+
+    // Seat was just reserved; `generation` is the engine's generation of that reservation
+    void hold(int seat, double now, uint32_t generation);
+    void release(int seat);            // reservation cancelled or purchased
+
+    // Releases every hold that expired by now, returns how many seats were freed
+    int expire(double now, BookingEngine &booking);
+
+private:
+    double ttl;
+    TimerWheel wheel;
+
+    static constexpr uint32_t NO_HOLD = UINT32_MAX;
+
+    // Generation of the seat's live hold, NO_HOLD if it has none. Timers carry the generation
+    // they were set for, so stale ones are skipped when they fire.
+    std::vector<uint32_t> holdGenerations;
+};
@@ -0,0 +1,83 @@
+#include "SeatBits.h"
+
+#include "Hall.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+
+static int highestBit(uint64_t w) { unsigned long i; _BitScanReverse64(&i, w); return static_cast<int>(i); }
+#elif defined(__GNUC__)
+static int highestBit(uint64_t w) { return 63 - __builtin_clzll(w); }
+#else
+static int highestBit(uint64_t w) { int i = 0; while (w >>= 1) i++; return i; }
+#endif
+
+// Largest row handled without allocating in runStarts
+constexpr int MAX_STACK_WORDS = 64;
+
+void SeatBits::build(int rows, int cols, const unsigned char *states) {
+    this->cols = cols;
+    words = (cols + 63) / 64;
+
+    // Bits past the last column stay 0, so runs never leave the row
+    freePlane.assign(rows * words, 0);
+
+    for (int i = 0; i < rows * cols; i++)
+        set(i, Seat::FREE);
+    allFreePlane = freePlane;
+
+    for (int i = 0; i < rows * cols; i++)
+        set(i, states[i]);
+}
+
+void SeatBits::reset() {
+    freePlane = allFreePlane;
+}
+
+void SeatBits::set(int seat, unsigned char state) {
+    int r = seat / cols, c = seat % cols;
+    int w = r * words + c / 64;
+    uint64_t bit = 1ull << (c % 64);
+
+    freePlane[w] = state == Seat::FREE ? freePlane[w] | bit : freePlane[w] & ~bit;
+}
+
+void SeatBits::runStarts(int r, int n, uint64_t *out) const {
+    const uint64_t *row = &freePlane[r * words];
+    for (int w = 0; w < words; w++) out[w] = row[w];
+
+    // out &= out >> k, ascending so every word is read before it is overwritten
+    auto andShifted = [&](int k) {
+        int q = k / 64, s = k % 64;
+
+        for (int w = 0; w < words; w++) {
+            uint64_t lo = w + q < words ? out[w + q] : 0;
+            uint64_t hi = w + q + 1 < words ? out[w + q + 1] : 0;
+            out[w] &= s == 0 ? lo : (lo >> s) | (hi << (64 - s));
+        }
+    };
+
+    // After each step bit c covers seats c..c+len-1, doubling len
+    int len = 1;
+    for (; len * 2 <= n; len *= 2) andShifted(len);
+    if (len < n) andShifted(n - len);
+}
+
+int SeatBits::findRunInRow(int r, int n) const {
+    if (n <= 0 || n > cols) return -1;
+
+    uint64_t stackBuffer[MAX_STACK_WORDS];
+    std::vector<uint64_t> heapBuffer;
+    uint64_t *starts = stackBuffer;
+    if (words > MAX_STACK_WORDS) {
+        heapBuffer.resize(words);
+        starts = heapBuffer.data();
+    }
+
+    runStarts(r, n, starts);
+
+    for (int w = words - 1; w >= 0; w--)
+        if (starts[w]) return w * 64 + highestBit(starts[w]);
+
+    return -1;
+}
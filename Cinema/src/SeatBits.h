@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Free seats as a bitplane, 64 seats of a row per word, so run searches work on whole
+// words instead of one seat at a time. Occupancy counts live in OccupiedSeats.
+class SeatBits {
+public:
+    void build(int rows, int cols, const unsigned char *states);
+    void set(int seat, unsigned char state);
+
+    // Back to an all-free hall: copy of the saved free plane
+    void reset();
+
+    // Start column of the rightmost run of n free seats in row r, or -1
+    int findRunInRow(int r, int n) const;
+
+private:
+    int cols = 0;
+    int words = 0;   // words per row
+
+    std::vector<uint64_t> freePlane;
+    std::vector<uint64_t> allFreePlane;
+
+    // Leaves bit c of out set iff seats c..c+n-1 of row r are all free
+    void runStarts(int r, int n, uint64_t *out) const;
+};
@@ -0,0 +1,189 @@
+#include "SeatIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+void SeatIndex::build(const float *xs, const float *ys, int count, float half, bool regular) {
+    this->count = count;
+    this->regular = regular;
+
+    boxes.resize(count);
+    for (int i = 0; i < count; i++)
+        boxes[i] = { xs[i] - half, ys[i] - half, xs[i] + half, ys[i] + half };
+
+    gridStart.clear();
+    gridItems.clear();
+    bvhNodes.clear();
+    bvhItems.clear();
+
+    if (count == 0) return;
+
+    if (regular)
+        buildGrid(2 * half);
+    else
+        buildBVH();
+}
+
+bool SeatIndex::contains(int seat, double x, double y) const {
+    const Box &b = boxes[seat];
+    return x > b.minX && x < b.maxX && y > b.minY && y < b.maxY;
+}
+
+bool SeatIndex::overlaps(int seat, double x0, double y0, double x1, double y1) const {
+    const Box &b = boxes[seat];
+    return x1 > b.minX && x0 < b.maxX && y1 > b.minY && y0 < b.maxY;
+}
+
+void SeatIndex::buildGrid(float seatWidth) {
+    Box all = boxes[0];
+    for (const Box &b : boxes) {
+        all.minX = std::min(all.minX, b.minX); all.maxX = std::max(all.maxX, b.maxX);
+        all.minY = std::min(all.minY, b.minY); all.maxY = std::max(all.maxY, b.maxY);
+    }
+
+    // One seat wide cells: a seat overlaps at most 2x2 cells, a point falls in exactly one
+    cellSize = seatWidth;
+    originX = all.minX;
+    originY = all.minY;
+    gridCols = static_cast<int>((all.maxX - originX) / cellSize) + 1;
+    gridRows = static_cast<int>((all.maxY - originY) / cellSize) + 1;
+
+    auto forEachCell = [&](int seat, auto f) {
+        const Box &b = boxes[seat];
+        int c0 = static_cast<int>((b.minX - originX) / cellSize);
+        int c1 = std::min(static_cast<int>((b.maxX - originX) / cellSize), gridCols - 1);
+        int r0 = static_cast<int>((b.minY - originY) / cellSize);
+        int r1 = std::min(static_cast<int>((b.maxY - originY) / cellSize), gridRows - 1);
+
+        for (int r = r0; r <= r1; r++)
+            for (int c = c0; c <= c1; c++)
+                f(r * gridCols + c);
+    };
+
+    // Counting sort into cells
+    gridStart.assign(gridRows * gridCols + 1, 0);
+    for (int i = 0; i < count; i++)
+        forEachCell(i, [&](int cell) { gridStart[cell + 1]++; });
+
+    for (size_t i = 1; i < gridStart.size(); i++)
+        gridStart[i] += gridStart[i - 1];
+
+    gridItems.resize(gridStart.back());
+    std::vector<int> fill(gridStart.begin(), gridStart.end() - 1);
+    for (int i = 0; i < count; i++)
+        forEachCell(i, [&](int cell) { gridItems[fill[cell]++] = i; });
+}
+
+void SeatIndex::buildBVH() {
+    bvhItems.resize(count);
+    for (int i = 0; i < count; i++) bvhItems[i] = i;
+
+    bvhNodes.reserve(2 * count);
+    buildBVHNode(0, count);
+}
+
+int SeatIndex::buildBVHNode(int first, int count) {
+    constexpr int LEAF_SIZE = 4;
+
+    Box b = boxes[bvhItems[first]];
+    for (int i = first; i < first + count; i++) {
+        const Box &s = boxes[bvhItems[i]];
+        b.minX = std::min(b.minX, s.minX); b.maxX = std::max(b.maxX, s.maxX);
+        b.minY = std::min(b.minY, s.minY); b.maxY = std::max(b.maxY, s.maxY);
+    }
+
+    int node = static_cast<int>(bvhNodes.size());
+    bvhNodes.push_back({ b, first, count, -1, -1 });
+    if (count <= LEAF_SIZE) return node;
+
+    // Median split along the longer axis
+    bool splitX = (b.maxX - b.minX) >= (b.maxY - b.minY);
+    int mid = first + count / 2;
+    std::nth_element(bvhItems.begin() + first, bvhItems.begin() + mid, bvhItems.begin() + first + count,
+        [&](int l, int r) { return splitX ? boxes[l].minX < boxes[r].minX : boxes[l].minY < boxes[r].minY; });
+
+    int left = buildBVHNode(first, mid - first);
+    int right = buildBVHNode(mid, first + count - mid);
+
+    bvhNodes[node].count = 0;
+    bvhNodes[node].left = left;
+    bvhNodes[node].right = right;
+    return node;
+}
+
+template <typename F>
+void SeatIndex::visitBVH(double x0, double y0, double x1, double y1, F visit) const {
+    if (bvhNodes.empty()) return;
+
+    int stack[64], top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const BVHNode &n = bvhNodes[stack[--top]];
+        if (x1 < n.bounds.minX || x0 > n.bounds.maxX || y1 < n.bounds.minY || y0 > n.bounds.maxY)
+            continue;
+
+        if (n.count > 0) {
+            for (int i = n.first; i < n.first + n.count; i++)
+                visit(bvhItems[i]);
+        }
+        else {
+            stack[top++] = n.left;
+            stack[top++] = n.right;
+        }
+    }
+}
+
+int SeatIndex::queryPoint(double x, double y) const {
+    int best = -1;
+
+    if (regular) {
+        if (count == 0) return -1;
+
+        int c = static_cast<int>(std::floor((x - originX) / cellSize));
+        int r = static_cast<int>(std::floor((y - originY) / cellSize));
+        if (c < 0 || r < 0 || c >= gridCols || r >= gridRows) return -1;
+
+        int cell = r * gridCols + c;
+        for (int i = gridStart[cell]; i < gridStart[cell + 1]; i++) {
+            int s = gridItems[i];
+            if (contains(s, x, y) && (best == -1 || s < best)) best = s;
+        }
+
+        return best;
+    }
+
+    visitBVH(x, y, x, y, [&](int s) {
+        if (contains(s, x, y) && (best == -1 || s < best)) best = s;
+    });
+
+    return best;
+}
+
+void SeatIndex::queryRect(double x0, double y0, double x1, double y1, std::vector<int> &out) const {
+    if (x0 > x1) std::swap(x0, x1);
+    if (y0 > y1) std::swap(y0, y1);
+    if (count == 0) return;
+
+    if (regular) {
+        int c0 = std::max(static_cast<int>(std::floor((x0 - originX) / cellSize)), 0);
+        int c1 = std::min(static_cast<int>(std::floor((x1 - originX) / cellSize)), gridCols - 1);
+        int r0 = std::max(static_cast<int>(std::floor((y0 - originY) / cellSize)), 0);
+        int r1 = std::min(static_cast<int>(std::floor((y1 - originY) / cellSize)), gridRows - 1);
+
+        size_t begin = out.size();
+        for (int r = r0; r <= r1; r++)
+            for (int c = c0; c <= c1; c++)
+                for (int i = gridStart[r * gridCols + c]; i < gridStart[r * gridCols + c + 1]; i++)
+                    if (overlaps(gridItems[i], x0, y0, x1, y1)) out.push_back(gridItems[i]);
+
+        // A seat spanning several cells is reported once
+        std::sort(out.begin() + begin, out.end());
+        out.erase(std::unique(out.begin() + begin, out.end()), out.end());
+        return;
+    }
+
+    visitBVH(x0, y0, x1, y1, [&](int s) {
+        if (overlaps(s, x0, y0, x1, y1)) out.push_back(s);
+    });
+}
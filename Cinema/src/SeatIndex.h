@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+
+// Spatial index over seat bounds (square of half size `half` around each seat).
+// Regular layouts use a uniform grid, so a point query looks at one cell;
+// irregular imported layouts fall back to a bounding volume hierarchy.
+class SeatIndex {
+public:
+    void build(const float *xs, const float *ys, int count, float half, bool regular);
+
+    // Lowest seat index whose bounds contain the point, or -1
+    int queryPoint(double x, double y) const;
+
+    // Appends every seat whose bounds overlap the rectangle
+    void queryRect(double x0, double y0, double x1, double y1, std::vector<int> &out) const;
+
+private:
+    struct Box {
+        float minX, minY, maxX, maxY;
+    };
+
+    struct BVHNode {
+        Box bounds;
+        int first, count;   // leaf: seats bvhItems[first .. first + count)
+        int left, right;    // inner node (count == 0): children
+    };
+
+    std::vector<Box> boxes;
+    int count = 0;
+    bool regular = true;
+
+    // Grid: seats of cell i are gridItems[gridStart[i] .. gridStart[i + 1])
+    float originX = 0, originY = 0, cellSize = 1;
+    int gridCols = 0, gridRows = 0;
+    std::vector<int> gridStart, gridItems;
+
+    std::vector<BVHNode> bvhNodes;
+    std::vector<int> bvhItems;
+
+    bool contains(int seat, double x, double y) const;
+    bool overlaps(int seat, double x0, double y0, double x1, double y1) const;
+
+    void buildGrid(float seatWidth);
+    void buildBVH();
+    int buildBVHNode(int first, int count);
+
+    // Calls visit(seat) for every seat in a BVH leaf whose bounds overlap the rectangle
+    template <typename F>
+    void visitBVH(double x0, double y0, double x1, double y1, F visit) const;
+};
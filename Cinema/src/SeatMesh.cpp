@@ -0,0 +1,91 @@
+#include "SeatMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+constexpr unsigned SeatMesh::RESTART;
+
+void SeatMesh::addRoundedRect(float cx, float cy, float halfW, float halfH, float radius, int segments) {
+    if (!indices.empty()) indices.push_back(RESTART);
+
+    unsigned first = static_cast<unsigned>(vertices.size() / 2);
+    radius = std::min(radius, std::min(halfW, halfH));
+    if (radius <= 0) segments = 0;
+
+    // corners counter-clockwise from top-left, matching the original box order
+    const float cornerX[4] = { -1, -1, 1, 1 }, cornerY[4] = { 1, -1, -1, 1 };
+    const float pi = 3.14159265f;
+
+    for (int c = 0; c < 4; c++) {
+        float ox = cx + cornerX[c] * (halfW - radius), oy = cy + cornerY[c] * (halfH - radius);
+        float start = std::atan2(cornerY[c], cornerX[c]) - pi / 4;
+
+        for (int s = 0; s <= segments; s++) {
+            float a = segments ? start + (pi / 2) * s / segments : 0;
+            vertices.push_back(segments ? ox + radius * std::cos(a) : ox);
+            vertices.push_back(segments ? oy + radius * std::sin(a) : oy);
+        }
+    }
+
+    unsigned count = static_cast<unsigned>(vertices.size() / 2) - first;
+    for (unsigned i = 0; i < count; i++) indices.push_back(first + i);
+
+    halfWidth = std::max(halfWidth, std::abs(cx) + halfW);
+    halfHeight = std::max(halfHeight, std::abs(cy) + halfH);
+}
+
+SeatMesh makeBasicSeatMesh() {
+    SeatMesh mesh;
+    mesh.addRoundedRect(0.0f, 0.3f, 0.55f, 0.2f, 0, 0);     // backrest
+    mesh.addRoundedRect(0.0f, -0.3f, 0.6f, 0.2f, 0, 0);     // cushion
+    mesh.addRoundedRect(-0.675f, 0.0f, 0.075f, 0.3f, 0, 0); // left armrest
+    mesh.addRoundedRect(0.675f, 0.0f, 0.075f, 0.3f, 0, 0);  // right armrest
+    return mesh;
+}
+
+SeatMesh makeRoundedSeatMesh() {
+    SeatMesh mesh;
+    mesh.addRoundedRect(0.0f, 0.3f, 0.55f, 0.2f, 0.12f, 6);
+    mesh.addRoundedRect(0.0f, -0.3f, 0.6f, 0.2f, 0.08f, 6);
+    mesh.addRoundedRect(-0.675f, 0.0f, 0.075f, 0.3f, 0.075f, 4);
+    mesh.addRoundedRect(0.675f, 0.0f, 0.075f, 0.3f, 0.075f, 4);
+    return mesh;
+}
+
+SeatMesh makeSeatQuadMesh() {
+    // a little larger than the seat, so the antialiased edge is not cut off
+    SeatMesh mesh;
+    mesh.addRoundedRect(0.0f, 0.0f, 0.8f, 0.55f, 0, 0);
+    return mesh;
+}
+
+SeatMesh makePersonMesh() {
+    SeatMesh mesh;
+    mesh.addRoundedRect(0.0f, 0.34f, 0.12f, 0.12f, 0.12f, 6);      // head
+    mesh.addRoundedRect(0.0f, 0.02f, 0.15f, 0.17f, 0.06f, 3);      // body
+    mesh.addRoundedRect(-0.21f, 0.04f, 0.045f, 0.15f, 0.045f, 3);  // arms
+    mesh.addRoundedRect(0.21f, 0.04f, 0.045f, 0.15f, 0.045f, 3);
+    mesh.addRoundedRect(-0.07f, -0.32f, 0.055f, 0.18f, 0.04f, 3);  // legs
+    mesh.addRoundedRect(0.07f, -0.32f, 0.055f, 0.18f, 0.04f, 3);
+    return mesh;
+}
+
+static std::map<std::string, SeatMeshGenerator> &seatMeshes() {
+    static std::map<std::string, SeatMeshGenerator> generators = {
+        { "basic", makeBasicSeatMesh },
+        { "rounded", makeRoundedSeatMesh },
+        { "sdf", makeSeatQuadMesh }
+    };
+    return generators;
+}
+
+void registerSeatMesh(const std::string &name, SeatMeshGenerator generator) {
+    seatMeshes()[name] = generator;
+}
+
+SeatMesh makeSeatMesh(const std::string &name) {
+    auto it = seatMeshes().find(name);
+    return it != seatMeshes().end() ? it->second() : makeBasicSeatMesh();
+}
+
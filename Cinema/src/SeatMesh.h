@@ -0,0 +1,37 @@
+#pragma once
+#include <GL/glew.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Shape of one seat in seat-size units, centred on the seat's position. Parts are
+// triangle fans separated by RESTART, so any level of detail is still one (instanced) draw.
+struct SeatMesh {
+    static constexpr unsigned RESTART = 0xffffffffu;
+
+    std::vector<float> vertices;    // x, y pairs
+    std::vector<unsigned> indices;
+    GLenum mode = GL_TRIANGLE_FAN;
+
+    float halfWidth = 0, halfHeight = 0;   // bounds, for repainting a changed seat
+
+    // Convex outline as one fan; corners rounded with `segments` steps when radius > 0
+    void addRoundedRect(float cx, float cy, float halfW, float halfH, float radius, int segments);
+};
+
+using SeatMeshGenerator = std::function<SeatMesh()>;
+
+// Backrest, cushion and two armrests as plain boxes
+SeatMesh makeBasicSeatMesh();
+// The same parts with rounded corners
+SeatMesh makeRoundedSeatMesh();
+// One quad around the seat; the shape comes from res/seat_sdf.frag
+SeatMesh makeSeatQuadMesh();
+
+// Not a seat: the little figure the moviegoers are drawn as, within [-0.5, 0.5]
+SeatMesh makePersonMesh();
+
+// Generators by name; registerSeatMesh adds or replaces one
+void registerSeatMesh(const std::string &name, SeatMeshGenerator generator);
+SeatMesh makeSeatMesh(const std::string &name);
+
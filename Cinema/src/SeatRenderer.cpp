@@ -0,0 +1,137 @@
+#include "SeatRenderer.h"
+
+#include <algorithm>
+#include <string>
+
+#include "GLState.h"
+
+constexpr int SeatRenderer::STATE_TEXTURE_WIDTH;
+
+void SeatRenderer::init(const SeatMesh &mesh) {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBOmesh);
+    glGenBuffers(1, &EBO);
+    glGenBuffers(1, &VBOpositions);
+    glGenTextures(1, &stateTexture);
+
+    glState().bindVertexArray(VAO);
+
+    // Mesh, shared by all instances
+    glState().bindArrayBuffer(VBOmesh);
+    glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(float), mesh.vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned), mesh.indices.data(), GL_STATIC_DRAW);
+    indexCount = static_cast<int>(mesh.indices.size());
+    mode = mesh.mode;
+
+    // Position (x, y), advanced once per instance; pointers are set in setPositions
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(2);
+
+    glState().bindVertexArray(0);
+
+    // integer texture, read with texelFetch only
+    glBindTexture(GL_TEXTURE_2D, stateTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void SeatRenderer::setPositions(const float *xs, const float *ys, int count) {
+    // xs followed by ys in one buffer
+    glState().bindArrayBuffer(VBOpositions);
+    glBufferData(GL_ARRAY_BUFFER, 2 * count * sizeof(float), NULL, GL_STATIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(float), xs);
+    glBufferSubData(GL_ARRAY_BUFFER, count * sizeof(float), count * sizeof(float), ys);
+
+    glState().bindVertexArray(VAO);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)(count * sizeof(float)));
+    glState().bindVertexArray(0);
+
+    // seat i is texel (i % width, i / width)
+    stateWidth = std::max(1, std::min(count, STATE_TEXTURE_WIDTH));
+    int stateHeight = std::max(1, (count + stateWidth - 1) / stateWidth);
+
+    glBindTexture(GL_TEXTURE_2D, stateTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, stateWidth, stateHeight, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, NULL);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    instanceCount = count;
+}
+
+void SeatRenderer::uploadStates(const unsigned char *states, int count) {
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, stateTexture);
+
+    int fullRows = count / stateWidth, rest = count % stateWidth;
+    if (fullRows > 0)
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, stateWidth, fullRows, GL_RED_INTEGER, GL_UNSIGNED_BYTE, states);
+    if (rest > 0)
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, fullRows, rest, 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE, states + fullRows * stateWidth);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void SeatRenderer::updateStates(const unsigned char *states, const std::vector<int> &dirtySeats) {
+    if (dirtySeats.empty()) return;
+
+    std::vector<int> &seats = pendingSeats;
+    seats.assign(dirtySeats.begin(), dirtySeats.end());
+    std::sort(seats.begin(), seats.end());
+    seats.erase(std::unique(seats.begin(), seats.end()), seats.end());
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glBindTexture(GL_TEXTURE_2D, stateTexture);
+
+    for (size_t i = 0; i < seats.size();) {
+        // extend the run while the next seat follows on the same texture row
+        int first = seats[i], last = first;
+        while (++i < seats.size() && seats[i] == last + 1 && seats[i] % stateWidth != 0)
+            last = seats[i];
+
+        glTexSubImage2D(GL_TEXTURE_2D, 0, first % stateWidth, first / stateWidth, last - first + 1, 1,
+            GL_RED_INTEGER, GL_UNSIGNED_BYTE, states + first);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void SeatRenderer::draw(const ShaderProgram &shader, float scale) const {
+    if (instanceCount == 0) return;
+
+    shader.use();
+    shader.setInt("uInstanced", GL_TRUE);
+    shader.setVec2("uScale", scale, scale);
+    shader.setVec2("uOffset", 0.0f, 0.0f);
+    shader.setInt("uSeatStates", STATE_TEXTURE_UNIT);
+
+    glActiveTexture(GL_TEXTURE0 + STATE_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, stateTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    // every part of every seat in one call, fans split by the restart index
+    glEnable(GL_PRIMITIVE_RESTART);
+    glPrimitiveRestartIndex(SeatMesh::RESTART);
+
+    glState().bindVertexArray(VAO);
+    glDrawElementsInstanced(mode, indexCount, GL_UNSIGNED_INT, (void*)0, instanceCount);
+
+    glDisable(GL_PRIMITIVE_RESTART);
+
+    shader.setInt("uInstanced", GL_FALSE);
+}
+
+void setSeatPalette(const ShaderProgram &shader, const float palette[][4], int count) {
+    shader.use();
+
+    for (int i = 0; i < count; i++) {
+        shader.setVec4("uPalette[" + std::to_string(i) + "]", palette[i]);
+    }
+}
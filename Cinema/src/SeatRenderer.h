@@ -0,0 +1,33 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+#include "SeatMesh.h"
+#include "ShaderProgram.h"
+
+// Draws every seat of the hall with one instanced call.
+// Positions live in an instance buffer; states in a one-byte-per-seat texture the vertex
+// shader reads with gl_InstanceID, so a changed seat costs one texel upload.
+struct SeatRenderer {
+    static constexpr int STATE_TEXTURE_WIDTH = 1024;
+    static constexpr int STATE_TEXTURE_UNIT = 1;
+
+    unsigned VAO = 0, VBOmesh = 0, EBO = 0, VBOpositions = 0, stateTexture = 0;
+    int indexCount = 0;
+    GLenum mode = GL_TRIANGLES;
+    int instanceCount = 0;
+    int stateWidth = 1;
+    std::vector<int> pendingSeats;   // sorted, deduplicated copy of the seats being updated; reused each frame
+
+    void init(const SeatMesh &mesh);
+    void setPositions(const float *xs, const float *ys, int count);
+
+    void uploadStates(const unsigned char *states, int count);
+    // Only the listed seats' texels; runs of neighbouring seats go up in one call
+    void updateStates(const unsigned char *states, const std::vector<int> &dirtySeats);
+
+    void draw(const ShaderProgram &shader, float scale) const;
+};
+
+void setSeatPalette(const ShaderProgram &shader, const float palette[][4], int count);
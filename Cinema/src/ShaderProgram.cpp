@@ -0,0 +1,46 @@
+#include "ShaderProgram.h"
+
+#include "GLState.h"
+#include "Util.h"
+
+ShaderProgram ShaderProgram::load(const char *vsSource, const char *fsSource) {
+    ShaderProgram shader;
+    shader.program = createShader(vsSource, fsSource);
+
+    int count = 0, maxLength = 0;
+    glGetProgramiv(shader.program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(shader.program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::string name(maxLength > 0 ? maxLength : 1, '\0');
+    for (int i = 0; i < count; i++) {
+        int length = 0, size = 0;
+        GLenum type;
+        glGetActiveUniform(shader.program, i, static_cast<GLsizei>(name.size()), &length, &size, &type, &name[0]);
+
+        // arrays are reported as "name[0]"; register every element and the bare name
+        std::string base(name.data(), length);
+        size_t bracket = base.find('[');
+        if (bracket == std::string::npos) {
+            shader.locations[base] = glGetUniformLocation(shader.program, base.c_str());
+            continue;
+        }
+
+        base.resize(bracket);
+        for (int e = 0; e < size; e++) {
+            std::string element = base + "[" + std::to_string(e) + "]";
+            shader.locations[element] = glGetUniformLocation(shader.program, element.c_str());
+        }
+        shader.locations[base] = shader.locations[base + "[0]"];
+    }
+
+    return shader;
+}
+
+void ShaderProgram::use() const {
+    glState().useProgram(program);
+}
+
+int ShaderProgram::location(const std::string &name) const {
+    auto it = locations.find(name);
+    return it == locations.end() ? -1 : it->second;
+}
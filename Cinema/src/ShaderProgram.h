@@ -0,0 +1,26 @@
+#pragma once
+#include <GL/glew.h>
+#include <string>
+#include <unordered_map>
+
+// A linked program from createShader with every active uniform's location looked up once,
+// right after linking. Setters act on the program currently in use, like glUniform*.
+class ShaderProgram {
+public:
+    static ShaderProgram load(const char *vsSource, const char *fsSource);
+
+    unsigned id() const { return program; }
+    void use() const;
+
+    // -1 for uniforms the compiler removed, which glUniform* ignores
+    int location(const std::string &name) const;
+
+    void setInt(const std::string &name, int v) const { glUniform1i(location(name), v); }
+    void setVec2(const std::string &name, float x, float y) const { glUniform2f(location(name), x, y); }
+    void setVec4(const std::string &name, float x, float y, float z, float w) const { glUniform4f(location(name), x, y, z, w); }
+    void setVec4(const std::string &name, const float *v) const { glUniform4fv(location(name), 1, v); }
+
+private:
+    unsigned program = 0;
+    std::unordered_map<std::string, int> locations;
+};
@@ -0,0 +1,25 @@
+#include "SpatialHash.h"
+
+void SpatialHash::build(const float *xs, const float *ys, const int *items, int count, float cellSize) {
+    inverseCell = 1.0f / cellSize;
+
+    uint32_t buckets = 16;
+    while (buckets < 2u * static_cast<uint32_t>(count)) buckets <<= 1;
+    mask = buckets - 1;
+
+    bucketStart.assign(buckets + 1, 0);
+    keys.resize(count);
+    entries.resize(count);
+
+    for (int k = 0; k < count; k++) {
+        int i = items[k];
+        keys[k] = bucket(cellOf(xs[i]), cellOf(ys[i]));
+        bucketStart[keys[k] + 1]++;
+    }
+    for (uint32_t b = 0; b < buckets; b++) bucketStart[b + 1] += bucketStart[b];
+
+    // place with a running cursor per bucket, then shift the starts back
+    for (int k = 0; k < count; k++) entries[bucketStart[keys[k]]++] = items[k];
+    for (uint32_t b = buckets; b > 0; b--) bucketStart[b] = bucketStart[b - 1];
+    bucketStart[0] = 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Points hashed by grid cell, for neighbour queries over an unbounded area. Rebuilt from
+// scratch with a counting sort (O(n)), so it suits points that all move every step.
+// The table has at least twice as many buckets as points; cells that share a bucket just
+// make a query look at a few extra points.
+class SpatialHash {
+public:
+    // Items are indices into xs/ys
+    void build(const float *xs, const float *ys, const int *items, int count, float cellSize);
+
+    // Calls fn(item) for everything in the 3x3 cells around the point, which covers every
+    // item within one cell size. An item can come up more than once when buckets collide.
+    template <class F>
+    void forEachNear(float x, float y, F &&fn) const {
+        if (entries.empty()) return;
+
+        int cx = cellOf(x), cy = cellOf(y);
+        for (int dy = -1; dy <= 1; dy++)
+            for (int dx = -1; dx <= 1; dx++) {
+                uint32_t b = bucket(cx + dx, cy + dy);
+                for (int k = bucketStart[b]; k < bucketStart[b + 1]; k++) fn(entries[k]);
+            }
+    }
+
+private:
+    float inverseCell = 1;
+    uint32_t mask = 0;
+    std::vector<int> bucketStart, entries;
+    std::vector<uint32_t> keys;
+
+    int cellOf(float v) const { return static_cast<int>(std::floor(v * inverseCell)); }
+    uint32_t bucket(int cx, int cy) const {
+        return (static_cast<uint32_t>(cx) * 73856093u ^ static_cast<uint32_t>(cy) * 19349663u) & mask;
+    }
+};
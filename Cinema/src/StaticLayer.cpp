@@ -0,0 +1,76 @@
+#include "StaticLayer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "GLState.h"
+
+void LayerRect::add(float cx, float cy, float halfW, float halfH) {
+    x0 = std::min(x0, cx - halfW);
+    y0 = std::min(y0, cy - halfH);
+    x1 = std::max(x1, cx + halfW);
+    y1 = std::max(y1, cy + halfH);
+}
+
+void LayerRect::add(const LayerRect &r) {
+    if (r.empty()) return;
+    x0 = std::min(x0, r.x0);
+    y0 = std::min(y0, r.y0);
+    x1 = std::max(x1, r.x1);
+    y1 = std::max(y1, r.y1);
+}
+
+void StaticLayer::init(int w, int h) {
+    width = w;
+    height = h;
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    // same size as the screen, sampled texel for pixel
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenFramebuffers(1, &FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void StaticLayer::begin(const LayerRect &area) {
+    glGetIntegerv(GL_VIEWPORT, savedViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glViewport(0, 0, width, height);
+
+    // NDC to pixels, rounded outwards so antialiasing-free edges are fully covered
+    int px0 = std::max(0, static_cast<int>(std::floor((area.x0 + 1) * 0.5f * width)) - 1);
+    int py0 = std::max(0, static_cast<int>(std::floor((area.y0 + 1) * 0.5f * height)) - 1);
+    int px1 = std::min(width, static_cast<int>(std::ceil((area.x1 + 1) * 0.5f * width)) + 1);
+    int py1 = std::min(height, static_cast<int>(std::ceil((area.y1 + 1) * 0.5f * height)) + 1);
+
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(px0, py0, std::max(0, px1 - px0), std::max(0, py1 - py0));
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void StaticLayer::end() {
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+}
+
+void StaticLayer::composite(const ShaderProgram &shader, unsigned quadVAO, const float dim[4]) const {
+    shader.use();
+    shader.setInt("uLayer", 0);
+    shader.setVec4("uDim", dim);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    glState().bindVertexArray(quadVAO);
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <GL/glew.h>
+
+#include "ShaderProgram.h"
+
+// Axis-aligned area in NDC, empty until something is added
+struct LayerRect {
+    float x0 = 1, y0 = 1, x1 = -1, y1 = -1;
+
+    bool empty() const { return x0 > x1 || y0 > y1; }
+    void add(float cx, float cy, float halfW, float halfH);
+    void add(const LayerRect &r);
+};
+
+// The parts of the frame that rarely change (canvas, seats, door), rendered once into a
+// texture and composited with a single full-screen quad. Only dirty areas are repainted:
+// the caller draws the same scene with the scissor limiting it to that area.
+class StaticLayer {
+public:
+    void init(int width, int height);
+
+    // Binds the layer and clears the area; everything drawn until end() lands only inside it
+    void begin(const LayerRect &area);
+    void end();
+
+    // One textured quad over the screen; the dim colour (alpha = strength) replaces the
+    // translucent overlay pass, so no extra full-screen blend is needed. Draw with blending off.
+    void composite(const ShaderProgram &shader, unsigned quadVAO, const float dim[4]) const;
+
+private:
+    unsigned FBO = 0, texture = 0;
+    int width = 0, height = 0;
+    int savedViewport[4] = { 0, 0, 0, 0 };
+};
@@ -0,0 +1,102 @@
+#include "StreamBuffer.h"
+
+#include "GLState.h"
+
+void StreamBuffer::init(size_t bytesPerFrame) {
+    regionSize = bytesPerFrame;
+    persistentMapping = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+
+    glGenBuffers(1, &VBO);
+    glState().bindArrayBuffer(VBO);
+
+    if (persistentMapping) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, regionSize * FRAMES, NULL, flags);
+        base = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, regionSize * FRAMES, flags));
+    }
+    else {
+        glBufferData(GL_ARRAY_BUFFER, regionSize * FRAMES, NULL, GL_STREAM_DRAW);
+    }
+}
+
+void StreamBuffer::orphan() {
+    // fresh storage under the same name; the driver frees the old one once the GPU is done
+    glBufferData(GL_ARRAY_BUFFER, regionSize * FRAMES, NULL, GL_STREAM_DRAW);
+
+    for (GLsync &fence : fences) {
+        if (fence) glDeleteSync(fence);
+        fence = 0;
+    }
+    counts.orphans++;
+}
+
+void StreamBuffer::beginFrame() {
+    region = (region + 1) % FRAMES;
+    used = 0;
+    counts.frames++;
+
+    glState().bindArrayBuffer(VBO);
+
+    GLsync &fence = fences[region];
+    if (fence) {
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        bool busy = status == GL_TIMEOUT_EXPIRED;
+
+        if (busy) counts.waits++;
+        if (busy && !persistentMapping) {
+            orphan();
+        }
+        else {
+            // persistent storage cannot be replaced, so block until the GPU lets go
+            if (busy) glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            glDeleteSync(fence);
+            fence = 0;
+        }
+    }
+
+    if (persistentMapping) {
+        mapped = base + region * regionSize;
+    }
+    else {
+        // the fence (or the orphaning) already guarantees the GPU is not reading this range
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_ARRAY_BUFFER, region * regionSize, regionSize,
+            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT));
+    }
+}
+
+StreamAllocation StreamBuffer::allocate(size_t bytes, size_t alignment) {
+    StreamAllocation allocation;
+    if (!mapped) return allocation;
+
+    // aligned to the vertex stride in absolute terms, so offset / stride is a base vertex
+    size_t start = region * regionSize + used;
+    start = (start + alignment - 1) / alignment * alignment;
+    size_t end = start + bytes;
+
+    if (end > (region + 1) * regionSize) {
+        counts.overflows++;
+        return allocation;
+    }
+
+    allocation.ptr = mapped + (start - region * regionSize);
+    allocation.offset = start;
+    used = end - region * regionSize;
+    return allocation;
+}
+
+void StreamBuffer::flush() {
+    if (persistentMapping || !mapped) return;
+
+    // draws cannot source a buffer that is mapped without the persistent bit
+    glState().bindArrayBuffer(VBO);
+    if (used > 0) glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, used);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    mapped = nullptr;
+}
+
+void StreamBuffer::endFrame() {
+    flush();
+    if (persistentMapping) mapped = nullptr;
+
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
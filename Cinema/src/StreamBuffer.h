@@ -0,0 +1,57 @@
+#pragma once
+#include <GL/glew.h>
+#include <cstddef>
+
+// Where an allocation landed: write through ptr, draw from offset in buffer()
+struct StreamAllocation {
+    void *ptr = nullptr;
+    size_t offset = 0;
+
+    explicit operator bool() const { return ptr != nullptr; }
+};
+
+struct StreamStats {
+    long long frames = 0;
+    long long waits = 0;       // the GPU still read a region we came back to
+    long long orphans = 0;     // ... and the storage was replaced instead of waiting
+    long long overflows = 0;   // allocations that did not fit in a frame's region
+};
+
+// Vertex data rewritten every frame (transient text, people, debug lines). One buffer split
+// into frame-sized regions used in turn; a fence after each frame's draws tells when its
+// region may be written again, so the CPU never writes over data the GPU is reading.
+//
+// With GL 4.4 / ARB_buffer_storage the buffer is mapped once, persistently and coherently.
+// Otherwise each frame maps its region unsynchronized; if the region is still busy the whole
+// buffer is orphaned rather than waited for.
+class StreamBuffer {
+public:
+    static constexpr int FRAMES = 3;
+
+    void init(size_t bytesPerFrame);
+
+    // Order per drawn frame: beginFrame, allocate..., flush, draw, endFrame
+    void beginFrame();
+    StreamAllocation allocate(size_t bytes, size_t alignment);
+    void flush();
+    void endFrame();
+
+    unsigned buffer() const { return VBO; }
+    bool persistent() const { return persistentMapping; }
+    const StreamStats &stats() const { return counts; }
+
+private:
+    unsigned VBO = 0;
+    size_t regionSize = 0;
+    bool persistentMapping = false;
+
+    unsigned char *base = nullptr;   // persistent mapping of the whole buffer
+    unsigned char *mapped = nullptr; // this frame's region, either mode
+    int region = 0;
+    size_t used = 0;
+
+    GLsync fences[FRAMES] = {};
+    StreamStats counts;
+
+    void orphan();
+};
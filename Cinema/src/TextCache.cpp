@@ -0,0 +1,159 @@
+#include "TextCache.h"
+
+#include <cstring>
+#include <vector>
+
+#include "GLState.h"
+
+#define STB_EASY_FONT_IMPLEMENTATION
+#include "stb_easy_font.h"
+
+void TextCache::reserveQuads(int quads) {
+    if (quads <= indexQuads) return;
+
+    // Same buffer name, so VAOs that already reference it keep working after it grows
+    int capacity = indexQuads ? indexQuads : 64;
+    while (capacity < quads) capacity *= 2;
+
+    std::vector<unsigned> indices(capacity * 6);
+    for (int q = 0; q < capacity; q++) {
+        unsigned v = q * 4;
+        unsigned quad[6] = { v, v + 1, v + 2, v, v + 2, v + 3 };
+        std::copy(quad, quad + 6, indices.begin() + q * 6);
+    }
+
+    if (!EBO) glGenBuffers(1, &EBO);
+    glState().bindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), indices.data(), GL_STATIC_DRAW);
+
+    indexQuads = capacity;
+}
+
+int TextCache::layout(const std::string &text, const TextStyle &style, std::vector<float> &vertices) {
+    // stb_easy_font writes 4 vertices of (x, y, z, color) per quad, roughly 270 bytes per char
+    scratch.resize(text.size() * 300 + 64);
+    stb_easy_font_spacing(style.spacing);
+    int quadCount = stb_easy_font_print(0, 0, const_cast<char*>(text.c_str()), NULL, scratch.data(), static_cast<int>(scratch.size() * sizeof(float)));
+
+    // Keep x and flipped y only
+    vertices.resize(quadCount * 4 * 2);
+    for (int v = 0; v < quadCount * 4; v++) {
+        vertices[v * 2] = scratch[v * 4];
+        vertices[v * 2 + 1] = -scratch[v * 4 + 1];
+    }
+
+    reserveQuads(quadCount);
+    return quadCount;
+}
+
+TextMesh TextCache::build(const std::string &text, const TextStyle &style) {
+    std::vector<float> vertices;
+    int quadCount = layout(text, style, vertices);
+
+    TextMesh mesh;
+    mesh.quadCount = quadCount;
+
+    glGenVertexArrays(1, &mesh.VAO);
+    glGenBuffers(1, &mesh.VBO);
+
+    glState().bindVertexArray(mesh.VAO);
+    glState().bindArrayBuffer(mesh.VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glState().bindVertexArray(0);
+
+    return mesh;
+}
+
+const TextMesh &TextCache::mesh(const std::string &text, const TextStyle &style) {
+    auto key = std::make_pair(text, style);
+    auto it = meshes.find(key);
+    if (it == meshes.end())
+        it = meshes.emplace(key, build(text, style)).first;
+
+    it->second.lastUsedFrame = frame;
+    return it->second;
+}
+
+void TextCache::drawMesh(const TextMesh &mesh, const TextStyle &style, const ShaderProgram &shader,
+    float offsetX, float offsetY, float scaleX, float scaleY) {
+    shader.use();
+    shader.setVec2("uOffset", offsetX, offsetY);
+    shader.setVec2("uScale", scaleX, scaleY);
+    shader.setVec4("uColor", style.r, style.g, style.b, style.a);
+
+    glState().bindVertexArray(mesh.VAO);
+    glDrawElements(GL_TRIANGLES, mesh.quadCount * 6, GL_UNSIGNED_INT, (void*)0);
+}
+
+TransientText TextCache::stream(StreamBuffer &buffer, const std::string &text, const TextStyle &style) {
+    TransientText transient;
+
+    auto key = std::make_pair(text, style);
+    auto it = streamed.find(key);
+    if (it == streamed.end()) {
+        it = streamed.emplace(key, StreamedText()).first;
+        it->second.quadCount = layout(text, style, it->second.vertices);
+    }
+    it->second.lastUsedFrame = frame;
+
+    const std::vector<float> &vertices = it->second.vertices;
+    const int quadCount = it->second.quadCount;
+
+    const size_t stride = 2 * sizeof(float);
+    StreamAllocation allocation = buffer.allocate(vertices.size() * sizeof(float), stride);
+    if (!allocation) return transient;
+    std::memcpy(allocation.ptr, vertices.data(), vertices.size() * sizeof(float));
+
+    // one VAO over the whole stream buffer; each string starts at its own base vertex
+    if (!streamVAO) {
+        glGenVertexArrays(1, &streamVAO);
+        glState().bindVertexArray(streamVAO);
+        glState().bindArrayBuffer(buffer.buffer());
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glState().bindVertexArray(0);
+    }
+
+    transient.VAO = streamVAO;
+    transient.baseVertex = static_cast<int>(allocation.offset / stride);
+    transient.quadCount = quadCount;
+    return transient;
+}
+
+void TextCache::drawTransient(const TransientText &transient, const TextStyle &style, const ShaderProgram &shader,
+    float offsetX, float offsetY, float scaleX, float scaleY) {
+    if (transient.quadCount == 0) return;
+
+    shader.use();
+    shader.setVec2("uOffset", offsetX, offsetY);
+    shader.setVec2("uScale", scaleX, scaleY);
+    shader.setVec4("uColor", style.r, style.g, style.b, style.a);
+
+    glState().bindVertexArray(transient.VAO);
+    glDrawElementsBaseVertex(GL_TRIANGLES, transient.quadCount * 6, GL_UNSIGNED_INT, (void*)0, transient.baseVertex);
+}
+
+void TextCache::endFrame() {
+    for (auto it = meshes.begin(); it != meshes.end();) {
+        if (frame - it->second.lastUsedFrame > EVICT_AFTER_FRAMES) {
+            glState().deleteBuffer(it->second.VBO);
+            glState().deleteVertexArray(it->second.VAO);
+            it = meshes.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    for (auto it = streamed.begin(); it != streamed.end();) {
+        if (frame - it->second.lastUsedFrame > EVICT_AFTER_FRAMES) it = streamed.erase(it);
+        else ++it;
+    }
+
+    frame++;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <GL/glew.h>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "ShaderProgram.h"
+#include "StreamBuffer.h"
+
+// How a string is laid out and drawn; part of the cache key
+struct TextStyle {
+    float spacing = 0;
+    float r = 1, g = 1, b = 1, a = 1;
+
+    bool operator<(const TextStyle &o) const {
+        return std::tie(spacing, r, g, b, a) < std::tie(o.spacing, o.r, o.g, o.b, o.a);
+    }
+};
+
+// stb_easy_font quads in their own VBO, 4 vertices per quad drawn through a shared index buffer
+struct TextMesh {
+    unsigned VAO = 0, VBO = 0;
+    int quadCount = 0;
+    int lastUsedFrame = 0;
+};
+
+// Text written into a StreamBuffer for one frame only
+struct TransientText {
+    unsigned VAO = 0;
+    int baseVertex = 0;
+    int quadCount = 0;
+};
+
+// Text meshes are laid out once per (string, style) and reused until they go unused,
+// so static labels cost one draw call per frame and changing counters only a rebuild.
+class TextCache {
+public:
+    // The cached mesh, built on first use; valid until endFrame() evicts it.
+    // drawMesh puts its top-left corner at offset (NDC), scale converts font pixels to NDC.
+    const TextMesh &mesh(const std::string &text, const TextStyle &style);
+    static void drawMesh(const TextMesh &mesh, const TextStyle &style, const ShaderProgram &shader,
+        float offsetX, float offsetY, float scaleX, float scaleY);
+
+    // For text that changes often: the quads are laid out once per (string, style) and kept
+    // like meshes, but copied into the frame's stream region instead of getting a VBO of their own
+    TransientText stream(StreamBuffer &buffer, const std::string &text, const TextStyle &style);
+    static void drawTransient(const TransientText &transient, const TextStyle &style, const ShaderProgram &shader,
+        float offsetX, float offsetY, float scaleX, float scaleY);
+
+    // Frees meshes and layouts that were not drawn for a while, e.g. old values of a live counter
+    void endFrame();
+
+private:
+    static constexpr int EVICT_AFTER_FRAMES = 120;
+
+    std::map<std::pair<std::string, TextStyle>, TextMesh> meshes;
+    int frame = 0;
+
+    // x, y pairs of 4 vertices per quad, ready to copy into the stream buffer
+    struct StreamedText {
+        std::vector<float> vertices;
+        int quadCount = 0;
+        int lastUsedFrame = 0;
+    };
+    std::map<std::pair<std::string, TextStyle>, StreamedText> streamed;
+
+    unsigned EBO = 0;
+    int indexQuads = 0;
+
+    unsigned streamVAO = 0;
+    std::vector<float> scratch;
+
+    // x, y pairs of 4 vertices per quad; returns the quad count
+    int layout(const std::string &text, const TextStyle &style, std::vector<float> &vertices);
+    TextMesh build(const std::string &text, const TextStyle &style);
+    void reserveQuads(int quads);
+};
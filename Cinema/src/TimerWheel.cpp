@@ -0,0 +1,77 @@
+#include "TimerWheel.h"
+
+#include <cmath>
+
+void TimerWheel::reset(double now) {
+    for (auto &level : slots)
+        for (auto &slot : level)
+            slot.clear();
+
+    origin = now;
+    current = 0;
+}
+
+uint64_t TimerWheel::toTick(double t) const {
+    double ticks = std::ceil((t - origin) / tickSeconds);
+    return ticks > 0 ? static_cast<uint64_t>(ticks) : 0;
+}
+
+uint64_t TimerWheel::passedTicks(double now) const {
+    double ticks = std::floor((now - origin) / tickSeconds);
+    return ticks > 0 ? static_cast<uint64_t>(ticks) : 0;
+}
+
+uint64_t TimerWheel::schedule(uint64_t id, double deadline) {
+    Timer timer = { id, toTick(deadline) };
+    if (timer.tick <= current) timer.tick = current + 1;
+
+    insert(timer);
+    return timer.tick;
+}
+
+void TimerWheel::insert(const Timer &timer) {
+    uint64_t delta = timer.tick > current ? timer.tick - current : 0;
+
+    // Lowest level whose range still covers the deadline; the top level wraps
+    // and the timer is simply cascaded again until it is close enough
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1ull << (SLOT_BITS * (level + 1))))
+        level++;
+
+    int slot = static_cast<int>((timer.tick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    slots[level][slot].push_back(timer);
+}
+
+void TimerWheel::advance(double now, const std::function<void(uint64_t id, uint64_t tick)> &fire) {
+    uint64_t target = passedTicks(now);
+
+    while (current < target) {
+        current++;
+
+        // Entering a new slot of level L: move its timers down to where they belong now
+        for (int level = 1; level < LEVELS; level++) {
+            if ((current & ((1ull << (SLOT_BITS * level)) - 1)) != 0) break;
+
+            int slot = static_cast<int>((current >> (SLOT_BITS * level)) & (SLOTS - 1));
+            std::vector<Timer> cascading;
+            cascading.swap(slots[level][slot]);
+
+            for (const Timer &timer : cascading)
+                insert(timer);
+        }
+
+        std::vector<Timer> &due = slots[0][current & (SLOTS - 1)];
+        for (size_t i = 0; i < due.size();) {
+            if (due[i].tick <= current) {
+                Timer timer = due[i];
+                due[i] = due.back();
+                due.pop_back();
+
+                fire(timer.id, timer.tick);
+            }
+            else {
+                i++;
+            }
+        }
+    }
+}
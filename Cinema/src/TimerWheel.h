@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Hierarchical timer wheel: LEVELS wheels of SLOTS slots, a slot on level L spans
+// SLOTS^L ticks. Scheduling is O(1) and each timer is cascaded at most LEVELS - 1
+// times, so advancing costs amortised O(1) per timer no matter how many are pending.
+// Time comes from the caller, so glfwGetTime() and a simulated clock both work.
+class TimerWheel {
+public:
+    explicit TimerWheel(double tickSeconds = 0.01) : tickSeconds(tickSeconds) {}
+
+    void reset(double now);
+
+    // The id is the caller's payload, handed back when the timer fires.
+    // Returns the tick the timer will fire on.
+    uint64_t schedule(uint64_t id, double deadline);
+
+    // Fires every timer due by now, in tick order
+    void advance(double now, const std::function<void(uint64_t id, uint64_t tick)> &fire);
+
+private:
+    static constexpr int LEVELS = 4, SLOT_BITS = 6, SLOTS = 1 << SLOT_BITS;
+
+    struct Timer {
+        uint64_t id;
+        uint64_t tick;
+    };
+
+    double tickSeconds;
+    double origin = 0;
+    uint64_t current = 0;
+
+    std::vector<Timer> slots[LEVELS][SLOTS];
+
+    // Deadlines round up to the tick that is not before them, the clock rounds down to the
+    // last tick it has passed, so nothing fires early
+    uint64_t toTick(double t) const;
+    uint64_t passedTicks(double now) const;
+    void insert(const Timer &timer);
+};